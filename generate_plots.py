@@ -104,6 +104,18 @@ def extract_thread_scaling_data(data):
                     }
                 }
             
+            # Roofline (solo se il benchmark è stato eseguito con roofline attivo)
+            if 'roofline' in thread_data:
+                variants = {}
+                for layout in ('soa', 'aos'):
+                    for variant_name, variant in thread_data[layout].items():
+                        if isinstance(variant, dict) and 'roofline' in variant:
+                            variants[f'{layout}_{variant_name}'] = variant['roofline']
+                thread_info['roofline'] = {
+                    'ceilings': thread_data['roofline'],
+                    'variants': variants
+                }
+            
             test_data['thread_data'][thread_count] = thread_info
         
         results.append(test_data)
@@ -289,6 +301,61 @@ def create_comprehensive_speedup_comparison(results, output_dir):
     plt.savefig(os.path.join(output_dir, 'comprehensive_speedup_comparison.png'), dpi=300, bbox_inches='tight')
     plt.close()
     
+def create_roofline_plots(results, output_dir):
+    for test_data in results:
+        test_name = test_data['test_name']
+        thread_counts = sorted(tc for tc, info in test_data['thread_data'].items() if 'roofline' in info)
+        if not thread_counts:
+            continue
+        
+        fig, (ax1, ax2) = plt.subplots(1, 2, figsize=(16, 6))
+        fig.suptitle(f'Roofline Analysis - {test_name}', fontsize=16, fontweight='bold')
+        
+        # Roofline al numero massimo di thread: banda in sola lettura e picco SAD
+        max_tc = thread_counts[-1]
+        roofline = test_data['thread_data'][max_tc]['roofline']
+        ceilings = roofline['ceilings']
+        variants = roofline['variants']
+        
+        intensities = [v['arithmetic_intensity'] for v in variants.values() if v] + [ceilings['ridge_intensity']]
+        x = np.logspace(np.log10(max(min(intensities) / 4, 0.01)), np.log10(max(intensities) * 4), 200)
+        ax1.plot(x, np.minimum(ceilings['peak_gflops'], x * ceilings['read_gb_per_s']), 'k-', linewidth=2,
+                 label=f'Read {ceilings["read_gb_per_s"]:.1f} GB/s, peak {ceilings["peak_gflops"]:.1f} GFLOP/s')
+        ax1.plot(x, np.minimum(ceilings['peak_gflops'], x * ceilings['triad_gb_per_s']), 'k--', linewidth=1,
+                 label=f'Triad {ceilings["triad_gb_per_s"]:.1f} GB/s')
+        
+        for name, metrics in sorted(variants.items()):
+            if metrics:
+                ax1.plot(metrics['arithmetic_intensity'], metrics['gflops'], 'o', markersize=8, label=name)
+        
+        ax1.set_xscale('log')
+        ax1.set_yscale('log')
+        ax1.set_xlabel('Arithmetic Intensity (FLOP/byte)')
+        ax1.set_ylabel('GFLOP/s')
+        ax1.set_title(f'Roofline ({max_tc} threads)')
+        ax1.legend(fontsize=8)
+        ax1.grid(True, alpha=0.3, which='both')
+        
+        # Frazione del limite raggiunta per variante al variare dei thread
+        variant_names = sorted({name for tc in thread_counts
+                                for name in test_data['thread_data'][tc]['roofline']['variants']})
+        for name in variant_names:
+            points = [(tc, test_data['thread_data'][tc]['roofline']['variants'][name].get('roofline_fraction', 0.0))
+                      for tc in thread_counts if name in test_data['thread_data'][tc]['roofline']['variants']]
+            ax2.plot([p[0] for p in points], [p[1] for p in points], 'o-', linewidth=2, markersize=6, label=name)
+        
+        ax2.set_xlabel('Number of Threads')
+        ax2.set_ylabel('Fraction of Roofline')
+        ax2.set_title('Achieved / Attainable Performance')
+        ax2.set_ylim(0, 1.05)
+        ax2.set_xticks(thread_counts)
+        ax2.legend(fontsize=8)
+        ax2.grid(True, alpha=0.3)
+        
+        plt.tight_layout()
+        plt.savefig(os.path.join(output_dir, f'roofline_{test_name}.png'), dpi=300, bbox_inches='tight')
+        plt.close()
+
 def create_baseline_comparison(results, output_dir):
     
     fig, ax = plt.subplots(figsize=(12, 6))
@@ -400,6 +467,9 @@ def main():
     print("Creating comprehensive speedup comparison...")
     create_comprehensive_speedup_comparison(results, output_dir)
         
+    print("Creating roofline plots...")
+    create_roofline_plots(results, output_dir)
+    
     print("Creating baseline comparison...")
     create_baseline_comparison(results, output_dir)
     
@@ -411,6 +481,7 @@ def main():
     print("  - thread_scaling_[test_name].png (individual analysis)")
     print("  - comprehensive_speedup_comparison.png")
     print("  - efficiency_heatmap.png")
+    print("  - roofline_[test_name].png (with roofline enabled)")
     print("  - baseline_comparison.png")
     print("  - thread_scaling_summary_table.png")
 
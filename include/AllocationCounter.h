@@ -0,0 +1,15 @@
+#ifndef ALLOCATIONCOUNTER_H
+#define ALLOCATIONCOUNTER_H
+
+#include <cstddef>
+
+// Conteggio delle allocazioni su heap (operator new globale sostituito in
+// AllocationCounter.cpp). Il conteggio è attivo solo dopo setEnabled(true).
+namespace AllocationCounter
+{
+    void setEnabled(bool enabled);
+    bool isEnabled();
+    size_t count();
+}
+
+#endif // ALLOCATIONCOUNTER_H
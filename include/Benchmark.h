@@ -1,6 +1,8 @@
 #ifndef BENCHMARK_H
 #define BENCHMARK_H
 
+#include "BenchmarkRegistry.h"
+#include "PerfCounters.h"
 #include "SearchEngine.h"
 #include <chrono>
 #include <string>
@@ -13,9 +15,9 @@ struct BenchmarkResult
 {
     std::string algorithm_name;
     std::string parallelization_type;
-    int num_series;
-    int series_length;
-    int query_length;
+    int num_series = 0; // con dataset_path: ricavati dal file
+    int series_length = 0;
+    int query_length = 0;
 
     std::vector<double> execution_times_ms;
     double mean_execution_time_ms;
@@ -27,50 +29,97 @@ struct BenchmarkResult
     double best_sad_value;
     int num_runs;
     bool results_match_reference = true;
+    double allocations_per_query = 0.0;
+    double pruned_fraction = 0.0;
+    SearchStats search_stats;
+    std::vector<double> thread_busy_ms; // varianti Collapsed e Tasks: tempo di lavoro per thread
+    double load_imbalance = 1.0;        // thread più carico / media
+    PerfSample perf;                    // contatori hardware sommati su tutte le esecuzioni
+
+    // Harness (Benchmark::benchmarkStrategy)
+    int warmup_runs = 0;
+    std::vector<double> rejected_times_ms; // outlier esclusi dalle statistiche
+    double ci_half_width_ms = 0.0;         // intervallo di confidenza al 95% della media
+    std::vector<double> sad_values;        // risultato della prima esecuzione misurata
+    double max_sad_difference = 0.0;       // rispetto ai sadValues di riferimento
+
+    // Esecuzioni misurate, outlier compresi (i contatori le coprono tutte)
+    int measured_runs() const { return num_runs + static_cast<int>(rejected_times_ms.size()); }
+};
+
+// Ripetizioni dell'harness: warmup_runs esecuzioni non misurate, poi almeno
+// min_runs; con ci_target > 0 si continua fino a max_runs finché la
+// semiampiezza dell'intervallo di confidenza al 95% supera ci_target volte
+// la media. Con outlier_mad > 0 sono scartati i tempi più lontani dalla
+// mediana di outlier_mad deviazioni assolute mediane (scalate a sigma)
+struct HarnessOptions
+{
+    int warmup_runs = 1;
+    int min_runs = 10;
+    int max_runs = 10;
+    double ci_target = 0.0;
+    double outlier_mad = 0.0;
 };
 
 struct TestConfiguration
 {
-    int num_series;
-    int series_length;
-    int query_length;
+    int num_series = 0; // con dataset_path: ricavati dal file
+    int series_length = 0;
+    int query_length = 0;
     int num_runs = 10;
     std::vector<int> thread_counts;
-    std::string dataset_path;
+    std::string dataset_path; // CSV esistente (con query_path) al posto del dataset generato
     std::string query_path;
+    std::string generator = "native"; // senza dataset_path: "native" (in memoria) o "python" (generate_timeseries.py, CSV)
+    int seed = 42;                    // seme del generatore nativo
+    int planted_queries = 0;          // > 0: copie della query piantate in serie distinte, verificate sui risultati
+    StorageLayout soa_layout = StorageLayout::ColumnMajor;
+    StorageLayout aos_layout = StorageLayout::RowMajor;
+    bool track_allocations = false;
+    std::string simd_isa = "auto"; // "auto", "scalar", "sse2", "avx2", "avx512"
+    bool early_abandon = false;
+    bool share_global_best = false;
+    bool lower_bounds = false;
+    std::string metric = "sad"; // "sad", "squared_euclidean", "chebyshev", "znorm_euclidean"
+    std::string engine = "auto"; // "auto", "direct", "fft" (solo metriche euclidee)
+    bool fft_crossover = false; // confronta kernel diretto e FFT (Inner SoA) su query di lunghezza crescente
+    bool matrix_profile = false; // matrix profile del dataset con finestre di lunghezza query_length
+    int top_k = 0; // > 0: misura anche la ricerca top-K sul dataset SoA
+    int batch_queries = 0; // > 0: confronta la ricerca batch con N chiamate indipendenti
+    int stream_batch = 0; // > 0: misura l'ingest in streaming a blocchi di stream_batch campioni per serie
+    bool binary_cache = true; // converte il CSV nel formato binario e lo mappa nelle esecuzioni successive
+    std::string numa_policy = "none"; // "none", "first_touch", "interleave" (no-op con un solo nodo NUMA)
+    std::string omp_places = "cores"; // "threads", "cores", "numa_domains"
+    std::string proc_bind = "";       // "close", "spread"; vuoto: affinità decisa dal runtime
+    std::string element_type = "float64"; // "float32", "int16", "int8": misura anche la ricerca sulla copia compatta
+    int index_block_length = 0; // > 0: indice min/max a blocchi di N campioni, salvato accanto al CSV
+    int approximate_stride = 0;          // > 0: misura la ricerca approssimata con questo stride
+    double approximate_recall = 0.0;     // > 0: stride e rifinitura calibrati per questa recall@approximate_k
+    double approximate_budget_ms = 0.0;  // > 0: budget di tempo della rifinitura
+    int approximate_k = 10;
+    bool perf_counters = false; // cicli, istruzioni, miss di cache e di branch via perf_event_open
+    bool roofline = false;      // misura banda e picco SAD per ogni numero di thread e li confronta con le varianti
+    std::string benchmarks = ""; // filtro sulle strategie registrate (BenchmarkRegistry::select), vuoto: tutte
+    int warmup_runs = 1;
+    int max_runs = 0;            // > num_runs: ripetizioni adattive fino a ci_target
+    double ci_target = 0.05;     // semiampiezza relativa dell'intervallo di confidenza al 95%
+    double outlier_mad = 0.0;    // > 0: scarta i tempi oltre outlier_mad MAD dalla mediana
 };
 
 class Benchmark
 {
 public:
-    // SoA
-    static BenchmarkResult benchmarkSequentialSoA(const TimeSeriesSoA &dataset,
-                                                  const TimeSeries &query,
-                                                  const std::string &test_name,
-                                                  int num_runs = 1);
-    static BenchmarkResult benchmarkSoA_parallelOuter(const TimeSeriesSoA &dataset,
-                                                      const TimeSeries &query,
-                                                      const std::string &test_name,
-                                                      int num_runs = 1);
-    static BenchmarkResult benchmarkSoA_parallelInner(const TimeSeriesSoA &dataset,
-                                                      const TimeSeries &query,
-                                                      const std::string &test_name,
-                                                      int num_runs = 1);
-
-    // AoS
-    static BenchmarkResult benchmarkSequentialAoS(const TimeSeriesAoS &dataset,
-                                                  const TimeSeries &query,
-                                                  const std::string &test_name,
-                                                  int num_runs = 1);
-    static BenchmarkResult benchmarkAoS_parallelOuter(const TimeSeriesAoS &dataset,
-                                                      const TimeSeries &query,
-                                                      const std::string &test_name,
-                                                      int num_runs = 1);
-    static BenchmarkResult benchmarkAoS_parallelInner(const TimeSeriesAoS &dataset,
-                                                      const TimeSeries &query,
-                                                      const std::string &test_name,
-                                                      int num_runs = 1);
+    // Strategia registrata con warmup, ripetizioni adattive e scarto degli
+    // outlier; con reference confronta i sadValues secondo strategy.check
+    static BenchmarkResult benchmarkStrategy(const BenchmarkStrategy &strategy,
+                                             const BenchmarkDatasets &datasets,
+                                             const TimeSeries &query,
+                                             const std::string &test_name,
+                                             const HarnessOptions &harness,
+                                             const SearchOptions &options = SearchOptions(),
+                                             const std::vector<double> *reference = nullptr);
 
+    // CSV del dataset con generate_timeseries.py (generator = "python")
     static bool generateDataset(const TestConfiguration &config);
 
     static nlohmann::json run_test(const TestConfiguration &config);
@@ -0,0 +1,48 @@
+#ifndef BENCHMARKCONFIG_H
+#define BENCHMARKCONFIG_H
+
+#include <string>
+#include <vector>
+#include "Benchmark.h"
+
+// Cosa eseguire e dove salvare i risultati
+struct BenchmarkPlan
+{
+    std::vector<TestConfiguration> tests;
+    std::string output_path = "output/benchmark_results/parallelization_analysis.json";
+    bool list_benchmarks = false;
+    bool help = false;
+};
+
+// Configurazione del benchmark da riga di comando e/o file JSON.
+// Le chiavi sono i nomi dei campi di TestConfiguration (le stesse di
+// "configuration" nei risultati, quindi un risultato può essere rieseguito);
+// sulla riga di comando diventano opzioni --nome-campo=valore.
+//
+// File JSON:
+//   {"output": "...", "defaults": {...}, "tests": [{...}, ...]}
+// dove ogni test eredita da "defaults" e dalle forme storiche se "tests" manca.
+// Anche un file di risultati è accettato: dei suoi test si legge solo
+// l'oggetto "configuration".
+// Le opzioni della riga di comando si applicano a tutti i test, dopo il file
+class BenchmarkConfig
+{
+public:
+    // 1, 2, 4, ... fino a maxThreads, più maxThreads se non è una potenza di due
+    static std::vector<int> defaultThreadCounts(int maxThreads);
+
+    // Le quattro forme storiche (num_series, series_length, query_length)
+    static std::vector<TestConfiguration> defaultTests();
+
+    static nlohmann::json toJson(const TestConfiguration &config);
+
+    // Applica le chiavi presenti; false (con error) per chiavi sconosciute o
+    // valori del tipo sbagliato
+    static bool applyJson(const nlohmann::json &options, TestConfiguration &config, std::string &error);
+
+    static bool parseArguments(int argc, char **argv, BenchmarkPlan &plan, std::string &error);
+
+    static std::string usage(const std::string &program);
+};
+
+#endif // BENCHMARKCONFIG_H
@@ -0,0 +1,82 @@
+#ifndef BENCHMARKREGISTRY_H
+#define BENCHMARKREGISTRY_H
+
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "SearchEngine.h"
+
+// Dati su cui gira una strategia: serve solo il dataset del suo layout.
+// Gli ingressi opzionali (nullptr o 0 se non richiesti dal test) abilitano
+// le strategie che ne hanno bisogno
+struct BenchmarkDatasets
+{
+    const TimeSeriesSoA *soa = nullptr;
+    const TimeSeriesAoS *aos = nullptr;
+
+    const CompactDataset *compact = nullptr;
+    const DatasetIndex *index = nullptr;
+    const ApproximateOptions *approximate = nullptr;
+    const std::vector<TimeSeries> *batchQueries = nullptr;       // la prima è la query del test
+    const std::vector<std::vector<double>> *streamFeeds = nullptr; // campioni di ogni serie, estratti fuori dalla misura
+    size_t streamBatch = 0;
+    size_t topK = 0;
+};
+
+// Confronto del risultato con i sadValues della baseline sequenziale
+enum class ResultCheck
+{
+    AllValues, // ricerca esatta: tutte le distanze
+    BestMatch, // solo la distanza minima (le altre serie possono essere scartate o stimate)
+    BestIndex  // solo la serie migliore: le distanze sono stime (copia compatta, approssimata)
+};
+
+// Una strategia di ricerca misurabile dall'harness di Benchmark.
+// Le strategie non parallele sono le baseline sequenziali: misurate una
+// volta con un thread, fanno da riferimento per speedup e risultati
+struct BenchmarkStrategy
+{
+    std::string layout; // "soa" o "aos"
+    std::string name;   // chiave nel JSON, es. "parallel_outer"
+    std::string label;  // nome leggibile per l'output a console
+    bool parallel = true;
+    std::function<std::pair<std::vector<double>, size_t>(const BenchmarkDatasets &, const TimeSeries &, const SearchOptions &)> search;
+
+    ResultCheck check = ResultCheck::AllValues;
+    bool allThreadCounts = false; // misurata anche con un thread (nessuna baseline sequenziale propria)
+
+    // Vuota: sempre disponibile
+    std::function<bool(const BenchmarkDatasets &)> available;
+    bool isAvailable(const BenchmarkDatasets &datasets) const { return !available || available(datasets); }
+
+    // Identificatore usato dai filtri, es. "soa.parallel_outer"
+    std::string id() const { return layout + "." + name; }
+};
+
+class BenchmarkRegistry
+{
+public:
+    // Registra una strategia (le varianti di SearchEngine sono già registrate);
+    // false se l'identificatore esiste già. Va chiamata prima di find/select:
+    // i puntatori restituiti non sopravvivono a una nuova registrazione
+    static bool add(const BenchmarkStrategy &strategy);
+
+    // Tutte le strategie, nell'ordine di registrazione
+    static const std::vector<BenchmarkStrategy> &all();
+
+    // nullptr se la strategia non esiste
+    static const BenchmarkStrategy *find(const std::string &layout, const std::string &name);
+
+    // Filtro: pattern separati da virgola sull'identificatore, con '*' come
+    // jolly; i pattern con '-' davanti escludono. Vuoto seleziona tutto.
+    // Es. "soa.*,-soa.parallel_tasks" oppure "*.parallel_outer"
+    static std::vector<const BenchmarkStrategy *> select(const std::string &filter);
+
+    static bool matches(const std::string &pattern, const std::string &id);
+
+private:
+    static std::vector<BenchmarkStrategy> &strategies();
+};
+
+#endif // BENCHMARKREGISTRY_H
@@ -0,0 +1,52 @@
+#ifndef BINARYDATASET_H
+#define BINARYDATASET_H
+
+#include <cstdint>
+#include <string>
+#include "TimeSeriesAoS.h"
+#include "TimeSeriesSoA.h"
+
+// Formato binario del dataset (little endian, versione 1):
+//   [header][lunghezze: numSeries x uint64][offset: numSeries x uint64][padding][dati]
+// I dati sono il buffer di FlatStorage così com'è in memoria, allineati ad
+// alignment byte nel file, quindi con mmap diventano subito una vista AoS o SoA
+// senza copie. offset e capacità sono espressi in elementi.
+constexpr char BINARY_DATASET_MAGIC[8] = {'T', 'S', 'D', 'A', 'T', 'A', 0, 0};
+constexpr uint32_t BINARY_DATASET_VERSION = 1;
+
+enum class BinaryDType : uint32_t
+{
+    Float64 = 1
+};
+
+struct BinaryDatasetHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;
+    uint32_t layout;
+    uint32_t alignment;
+    uint64_t numSeries;
+    uint64_t tileWidth;
+    uint64_t rowCapacity;
+    uint64_t columnCapacity;
+    uint64_t indexOffset;
+    uint64_t dataOffset;
+    uint64_t dataElements;
+};
+
+static_assert(sizeof(BinaryDatasetHeader) == 80, "binary header layout must not change within a version");
+
+// Scrive il dataset nel layout in cui è memorizzato
+bool writeBinaryDataset(const std::string &filename, const TimeSeriesSoA &dataset);
+bool writeBinaryDataset(const std::string &filename, const TimeSeriesAoS &dataset);
+
+// Legge e valida solo l'header
+bool readBinaryDatasetHeader(const std::string &filename, BinaryDatasetHeader &header);
+
+// Mappa il file in sola lettura: il dataset restituito usa direttamente le
+// pagine del file (layout quello del file). In caso di errore il dataset è vuoto.
+TimeSeriesSoA mapTimeSeriesSoA(const std::string &filename);
+TimeSeriesAoS mapTimeSeriesAoS(const std::string &filename);
+
+#endif // BINARYDATASET_H
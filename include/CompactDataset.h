@@ -0,0 +1,117 @@
+#ifndef COMPACTDATASET_H
+#define COMPACTDATASET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "AlignedAllocator.h"
+#include "TimeSeriesSoA.h"
+
+// Tipo degli elementi di una copia compatta del dataset (Float64 = dataset originale)
+enum class ElementType
+{
+    Float64,
+    Float32,
+    Int16,
+    Int8
+};
+
+inline std::string elementTypeName(ElementType type)
+{
+    switch (type)
+    {
+    case ElementType::Float64:
+        return "float64";
+    case ElementType::Float32:
+        return "float32";
+    case ElementType::Int16:
+        return "int16";
+    case ElementType::Int8:
+        return "int8";
+    }
+    return "unknown";
+}
+
+inline bool parseElementType(const std::string &name, ElementType &type)
+{
+    for (ElementType candidate : {ElementType::Float64, ElementType::Float32, ElementType::Int16, ElementType::Int8})
+    {
+        if (elementTypeName(candidate) == name)
+        {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// SAD minima approssimata di una serie: la SAD esatta (in double) di ogni
+// finestra, e quindi anche il minimo, sta in [minSad - error, minSad + error]
+struct CompactEstimate
+{
+    double minSad;
+    double error;
+};
+
+// Query convertita nella rappresentazione di ciascuna serie, riutilizzata tra le serie
+struct CompactScratch
+{
+    AlignedVector<float> floatQuery;
+    AlignedVector<uint16_t> wordQuery;
+    AlignedVector<uint8_t> byteQuery;
+};
+
+// Copia del dataset con elementi più piccoli del double, per ridurre la banda
+// di memoria della scansione SAD:
+// - Float32: valori convertiti a float, distanze calcolate in float
+// - Int16 / Int8: livelli interi senza segno per serie, x ~ base + livello * scale
+//   (65535 o 255 livelli tra minimo e massimo della serie), SAD intera esatta
+//   sui livelli e moltiplicata per scale
+// Le serie sono contigue (row-major) e allineate alla cache line. Ogni stima
+// porta con sé un limite dell'errore, usato da SearchEngine::searchCompactSoA
+// per il re-rank esatto dei candidati.
+class CompactDataset
+{
+public:
+    CompactDataset() = default;
+
+    // Float64 non ha una rappresentazione compatta: dataset vuoto
+    static CompactDataset build(const TimeSeriesSoA &dataset, ElementType type);
+
+    ElementType getType() const { return type; }
+    size_t getNumSeries() const { return lengths.size(); }
+    size_t getSeriesLength(size_t seriesIndex) const { return lengths[seriesIndex]; }
+    size_t sizeInBytes() const;
+
+    // Query più lunghe non sono rappresentabili negli accumulatori interi
+    static size_t maxQueryLength(ElementType type);
+
+    // Tutte le finestre della serie (almeno queryLength campioni)
+    CompactEstimate approximateMinSad(size_t seriesIndex, const double *query, size_t queryLength,
+                                      CompactScratch &scratch) const;
+
+private:
+    template <typename T>
+    void buildSeries(const TimeSeriesSoA &dataset, AlignedVector<T> &values, double levels);
+
+    template <typename T>
+    CompactEstimate estimate(const AlignedVector<T> &values, size_t seriesIndex, const double *query,
+                             size_t queryLength, AlignedVector<T> &quantizedQuery) const;
+
+    ElementType type = ElementType::Float64;
+    AlignedVector<float> floats;
+    AlignedVector<uint16_t> words;
+    AlignedVector<uint8_t> bytes;
+
+    std::vector<size_t> offsets;
+    std::vector<size_t> lengths;
+
+    // Decodifica per serie (base 0 e scale 1 per Float32) e massimo errore di
+    // rappresentazione di un singolo campione
+    std::vector<double> base;
+    std::vector<double> scale;
+    std::vector<double> sampleError;
+};
+
+#endif // COMPACTDATASET_H
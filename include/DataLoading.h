@@ -10,9 +10,32 @@
 #include "TimeSeriesSoA.h"
 
 
-std::vector<TimeSeries> loadTimeSeriesAoS(const std::string &filename);
+// Statistiche di caricamento di un CSV
+struct CsvLoadStats
+{
+    size_t bytes = 0;
+    size_t numSeries = 0;
+    double seconds = 0.0;
 
-TimeSeriesSoA loadTimeSeriesSoA(const std::string &filename);
+    double megabytesPerSecond() const
+    {
+        return seconds > 0.0 ? bytes / (1024.0 * 1024.0) / seconds : 0.0;
+    }
+};
+
+// Il file viene mappato, diviso in blocchi di righe intere e analizzato in
+// parallelo (std::from_chars, nessuna allocazione per campo); i valori sono
+// scritti direttamente nello storage finale. Se il file non esiste viene
+// stampato un errore e il dataset restituito è vuoto.
+std::vector<TimeSeries> loadTimeSeriesAoS(const std::string &filename, CsvLoadStats *stats = nullptr);
+
+TimeSeriesAoS loadTimeSeriesAoSDataset(const std::string &filename,
+                                       StorageLayout layout = StorageLayout::RowMajor,
+                                       CsvLoadStats *stats = nullptr);
+
+TimeSeriesSoA loadTimeSeriesSoA(const std::string &filename,
+                                StorageLayout layout = StorageLayout::ColumnMajor,
+                                CsvLoadStats *stats = nullptr);
 
 TimeSeries loadQueryFromCSV(const std::string &filename);
 
@@ -0,0 +1,48 @@
+#ifndef DATASETBUILDER_H
+#define DATASETBUILDER_H
+
+#include <string>
+#include <vector>
+#include "TimeSeriesAoS.h"
+#include "TimeSeriesSoA.h"
+
+// Tempo e memoria di una fase della costruzione dei dataset
+struct DatasetBuildPhase
+{
+    std::string name;
+    double time_ms;
+    size_t rss_bytes;
+    size_t peak_rss_bytes;
+};
+
+struct DatasetBuildReport
+{
+    std::string soa_source; // "csv", "binary" o "relayout"
+    std::string aos_source;
+    double csv_mb_per_s = 0.0;
+    std::vector<DatasetBuildPhase> phases;
+};
+
+// Costruisce il dataset in entrambi i layout con un solo caricamento: le cache
+// binarie fresche vengono mappate, altrimenti il CSV viene analizzato una volta
+// e l'altro layout è ottenuto con una trasposizione parallela a blocchi
+class DatasetBuilder
+{
+public:
+    static bool build(const std::string &csvPath,
+                      StorageLayout soaLayout,
+                      StorageLayout aosLayout,
+                      bool useBinaryCache,
+                      TimeSeriesSoA &soa,
+                      TimeSeriesAoS &aos,
+                      DatasetBuildReport *report = nullptr);
+
+    // Copia in un altro layout, a blocchi di serie x istanti distribuiti tra i thread
+    static TimeSeriesAoS toAoS(const TimeSeriesSoA &dataset, StorageLayout layout);
+    static TimeSeriesSoA toSoA(const TimeSeriesAoS &dataset, StorageLayout layout);
+
+    // Percorso della cache binaria di un CSV per un layout
+    static std::string binaryCachePath(const std::string &csvPath, StorageLayout layout);
+};
+
+#endif // DATASETBUILDER_H
@@ -0,0 +1,83 @@
+#ifndef DATASETINDEX_H
+#define DATASETINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "TimeSeriesAoS.h"
+#include "TimeSeriesSoA.h"
+
+// Formato su disco dell'indice (little endian, versione 1):
+//   [header][lunghezze: numSeries x uint64][minimi: numBlocks x double][massimi: numBlocks x double]
+// I blocchi di ogni serie sono consecutivi, nell'ordine delle serie
+constexpr char DATASET_INDEX_MAGIC[8] = {'T', 'S', 'I', 'N', 'D', 'E', 'X', 0};
+constexpr uint32_t DATASET_INDEX_VERSION = 1;
+
+struct DatasetIndexHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t blockLength;
+    uint64_t numSeries;
+    uint64_t numBlocks;
+};
+
+static_assert(sizeof(DatasetIndexHeader) == 40, "index header layout must not change within a version");
+
+// Indice persistente del dataset: minimo e massimo di ogni blocco di
+// blockLength campioni consecutivi di ogni serie. Le finestre che iniziano
+// nel blocco b leggono, alla posizione k della query, campioni dei blocchi
+// b + k / blockLength e b + k / blockLength + 1: la distanza di q_k
+// dall'envelope di quei due blocchi, sommata su k, è un lower bound della
+// SAD di tutte le finestre del blocco (SearchEngine::searchIndexedSoA/AoS)
+class DatasetIndex
+{
+public:
+    static constexpr size_t DEFAULT_BLOCK_LENGTH = 64;
+
+    DatasetIndex() = default;
+
+    static DatasetIndex build(const TimeSeriesSoA &dataset, size_t blockLength = DEFAULT_BLOCK_LENGTH);
+    static DatasetIndex build(const TimeSeriesAoS &dataset, size_t blockLength = DEFAULT_BLOCK_LENGTH);
+
+    // In caso di errore load restituisce un indice vuoto
+    bool save(const std::string &filename) const;
+    static DatasetIndex load(const std::string &filename);
+
+    // Percorso dell'indice accanto al CSV del dataset, per una lunghezza di blocco
+    static std::string indexPath(const std::string &csvPath, size_t blockLength);
+
+    // L'indice descrive un dataset con lo stesso numero di serie e le stesse lunghezze
+    bool matches(const TimeSeriesSoA &dataset) const;
+    bool matches(const TimeSeriesAoS &dataset) const;
+
+    bool empty() const { return blockLength == 0; }
+    size_t getBlockLength() const { return blockLength; }
+    size_t getNumSeries() const { return lengths.size(); }
+    size_t getSeriesLength(size_t seriesIndex) const { return lengths[seriesIndex]; }
+    size_t getNumBlocks(size_t seriesIndex) const { return firstBlock[seriesIndex + 1] - firstBlock[seriesIndex]; }
+    size_t sizeInBytes() const;
+
+    // Lower bound della SAD di tutte le finestre di lunghezza queryLength che
+    // iniziano nel blocco block della serie
+    double blockBound(size_t seriesIndex, size_t block, const double *query, size_t queryLength) const;
+
+private:
+    template <typename Dataset>
+    static DatasetIndex buildIndex(const Dataset &dataset, size_t blockLength);
+
+    template <typename Dataset>
+    bool matchesDataset(const Dataset &dataset) const;
+
+    void assignBlocks();
+
+    size_t blockLength = 0;
+    std::vector<size_t> lengths;
+    std::vector<size_t> firstBlock;
+    std::vector<double> blockMin;
+    std::vector<double> blockMax;
+};
+
+#endif // DATASETINDEX_H
@@ -0,0 +1,175 @@
+#ifndef DISTANCEMETRICS_H
+#define DISTANCEMETRICS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <string>
+
+enum class DistanceMetric
+{
+    Sad,              // sum_k |s_k - q_k|
+    SquaredEuclidean, // sum_k (s_k - q_k)^2
+    Chebyshev,        // max_k |s_k - q_k|
+    ZNormEuclidean    // sum_k (z(s)_k - z(q)_k)^2, finestra e query z-normalizzate
+};
+
+// Policy delle metriche, parametri template dei kernel (DistanceKernels.cpp):
+// il loop interno viene specializzato per ogni metrica senza branch a runtime.
+// accumulate() è un template per valere sia su double sia sui vettori
+// (estensioni vector_size di GCC/Clang) usati dai kernel.
+// I vettori passano solo per riferimento e le policy sono sempre inline: i
+// kernel AVX2/AVX-512 hanno l'attributo target, e un vettore largo passato
+// per valore a una funzione senza target userebbe un'ABI diversa.
+// Il termine è sempre >= 0 e l'accumulo è monotono, quindi l'early abandon
+// resta valido per tutte le metriche.
+#define METRIC_INLINE __attribute__((always_inline)) inline
+
+struct SadMetric
+{
+    static constexpr bool normalized = false;
+
+    // acc += |s - q|
+    template <typename T>
+    static METRIC_INLINE void accumulate(T &acc, const T &s, const T &q)
+    {
+        T diff = s - q;
+        acc += diff < T{} ? -diff : diff;
+    }
+};
+
+struct SquaredEuclideanMetric
+{
+    static constexpr bool normalized = false;
+
+    // acc += (s - q)^2
+    template <typename T>
+    static METRIC_INLINE void accumulate(T &acc, const T &s, const T &q)
+    {
+        T diff = s - q;
+        acc += diff * diff;
+    }
+};
+
+struct ChebyshevMetric
+{
+    static constexpr bool normalized = false;
+
+    // acc = max(acc, |s - q|)
+    template <typename T>
+    static METRIC_INLINE void accumulate(T &acc, const T &s, const T &q)
+    {
+        T diff = s - q;
+        T term = diff < T{} ? -diff : diff;
+        acc = acc > term ? acc : term;
+    }
+};
+
+// La query viene z-normalizzata una volta per ricerca; media e deviazione
+// standard delle finestre vengono da somme scorrevoli, O(1) per offset
+struct ZNormEuclideanMetric
+{
+    static constexpr bool normalized = true;
+
+    template <typename T>
+    static METRIC_INLINE void accumulate(T &acc, const T &s, const T &q)
+    {
+        SquaredEuclideanMetric::accumulate(acc, s, q);
+    }
+};
+
+// Inverso della deviazione standard di una finestra; 0 per le finestre
+// (quasi) costanti, che normalizzate diventano tutte zero
+inline double zNormInvStd(double mean, double variance)
+{
+    return variance > 1e-12 * std::max(1.0, mean * mean) ? 1.0 / std::sqrt(variance) : 0.0;
+}
+
+// Query z-normalizzata in out; una query costante diventa tutta zero
+inline void zNormalize(const double *values, size_t length, double *out)
+{
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    for (size_t k = 0; k < length; ++k)
+    {
+        sum += values[k];
+        sumSquares += values[k] * values[k];
+    }
+
+    double mean = length > 0 ? sum / length : 0.0;
+    double variance = length > 0 ? sumSquares / length - mean * mean : 0.0;
+    double invStd = zNormInvStd(mean, variance);
+    for (size_t k = 0; k < length; ++k)
+    {
+        out[k] = (values[k] - mean) * invStd;
+    }
+}
+
+inline std::string distanceMetricName(DistanceMetric metric)
+{
+    switch (metric)
+    {
+    case DistanceMetric::Sad:
+        return "sad";
+    case DistanceMetric::SquaredEuclidean:
+        return "squared_euclidean";
+    case DistanceMetric::Chebyshev:
+        return "chebyshev";
+    case DistanceMetric::ZNormEuclidean:
+        return "znorm_euclidean";
+    }
+    return "unknown";
+}
+
+// Calcolo delle distanze scorrevoli: kernel diretto O(m) per offset o FFT
+// (FftDistance.h, solo metriche euclidee); Auto sceglie in base a queryLength
+// e alla lunghezza della serie
+enum class DistanceEngine
+{
+    Auto,
+    Direct,
+    Fft
+};
+
+inline std::string distanceEngineName(DistanceEngine engine)
+{
+    switch (engine)
+    {
+    case DistanceEngine::Auto:
+        return "auto";
+    case DistanceEngine::Direct:
+        return "direct";
+    case DistanceEngine::Fft:
+        return "fft";
+    }
+    return "unknown";
+}
+
+inline bool parseDistanceEngine(const std::string &name, DistanceEngine &engine)
+{
+    for (DistanceEngine candidate : {DistanceEngine::Auto, DistanceEngine::Direct, DistanceEngine::Fft})
+    {
+        if (distanceEngineName(candidate) == name)
+        {
+            engine = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool parseDistanceMetric(const std::string &name, DistanceMetric &metric)
+{
+    for (DistanceMetric candidate : {DistanceMetric::Sad, DistanceMetric::SquaredEuclidean,
+                                     DistanceMetric::Chebyshev, DistanceMetric::ZNormEuclidean})
+    {
+        if (distanceMetricName(candidate) == name)
+        {
+            metric = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif // DISTANCEMETRICS_H
@@ -0,0 +1,37 @@
+#ifndef FFT_H
+#define FFT_H
+
+#include <cstddef>
+#include <vector>
+#include "AlignedAllocator.h"
+
+// FFT complessa radix-2 iterativa (Cooley-Tukey) su potenze di 2, con
+// twiddle e permutazione bit-reversal precalcolati: un piano per dimensione,
+// riutilizzabile in sola lettura da più thread. Parti reale e immaginaria in
+// array separati, così le butterfly di uno stadio si vettorizzano sul loop interno
+class FftPlan
+{
+public:
+    explicit FftPlan(size_t size);
+
+    size_t size() const { return n; }
+
+    // In place; inverse non normalizzata (il risultato va diviso per size())
+    void forward(double *real, double *imag) const;
+    void inverse(double *real, double *imag) const;
+
+    static size_t nextPowerOfTwo(size_t value);
+
+private:
+    void transform(double *real, double *imag, bool inverse) const;
+
+    size_t n;
+    std::vector<size_t> bitReversed;
+
+    // Twiddle exp(-2*pi*i*k/(2h)), k in [0, h), dello stadio con semiampiezza h
+    // a partire dall'indice h - 1: ogni stadio legge un tratto contiguo
+    AlignedVector<double> twiddleReal;
+    AlignedVector<double> twiddleImag;
+};
+
+#endif // FFT_H
@@ -0,0 +1,81 @@
+#ifndef FFTDISTANCE_H
+#define FFTDISTANCE_H
+
+#include <cstddef>
+#include <vector>
+#include "AlignedAllocator.h"
+#include "DistanceMetrics.h"
+#include "Fft.h"
+
+// Buffer riutilizzati tra le serie dallo stesso thread
+struct FftScratch
+{
+    AlignedVector<double> real;
+    AlignedVector<double> imag;
+    AlignedVector<double> distances;
+};
+
+// Distanze scorrevoli in stile MASS: i prodotti scalari QT[j] = sum_k s[j+k] q[k]
+// di tutti gli offset si ottengono con una convoluzione via FFT (overlap-save a
+// blocchi di dimensione fissa, O(log N) per offset invece di O(m)), poi
+//   SquaredEuclidean: sum s^2 - 2 QT + sum q^2
+//   ZNormEuclidean:   sum zs^2 - 2 (QT - mu sum zq) / sigma + sum zq^2
+// con media e varianza delle finestre da somme scorrevoli. Due blocchi reali
+// viaggiano in un'unica FFT complessa (parte reale e immaginaria), dato che
+// lo spettro della query è quello di un segnale reale.
+// I risultati coincidono con il kernel diretto a meno di errori di arrotondamento
+// (~1e-12 relativo all'energia delle finestre); SAD e Chebyshev non sono supportate.
+class FftDistance
+{
+public:
+    // Dimensione del blocco FFT: potenza di 2 >= FFT_BLOCK_FACTOR * queryLength
+    static constexpr size_t FFT_BLOCK_FACTOR = 8;
+    static constexpr size_t FFT_MIN_BLOCK = 64;
+
+    // Modello di costo, in unità di un termine del kernel diretto per la
+    // SquaredEuclidean (misurato con i kernel AVX-512): un punto di FFT per
+    // livello log2, incluse copia, prodotto con lo spettro e distanze, costa
+    // FFT_POINT_COST termini; un termine z-normalizzato ZNORM_TERM_COST
+    static constexpr double FFT_POINT_COST = 14.0;
+    static constexpr double ZNORM_TERM_COST = 2.5;
+
+    static bool supports(DistanceMetric metric);
+
+    // query già nella forma del kernel diretto (z-normalizzata per ZNormEuclidean)
+    FftDistance(const double *query, size_t queryLength, DistanceMetric metric);
+
+    // true se sugli offset [0, numOffsets) di una serie l'FFT costa meno del kernel diretto
+    bool preferred(size_t numOffsets) const;
+
+    // Dimensione minima della serie (in campioni) da cui preferred() sceglie l'FFT
+    size_t crossoverLength() const;
+
+    double minDistance(const double *series, size_t numOffsets, FftScratch &scratch) const;
+    void slidingDistance(const double *series, size_t numOffsets, double *out, FftScratch &scratch) const;
+
+private:
+    struct Block
+    {
+        FftPlan plan;
+
+        // FFT della query invertita, già divisa per N
+        AlignedVector<double> queryReal;
+        AlignedVector<double> queryImag;
+    };
+
+    const Block &blockFor(size_t numOffsets) const;
+    double directCost(size_t numOffsets) const;
+    double fftCost(size_t numOffsets) const;
+    void blockDistances(const double *series, size_t offsets, const double *dots, double *out) const;
+
+    std::vector<double> query;
+    size_t queryLength;
+    DistanceMetric metric;
+    double querySum = 0.0;
+    double querySumSquares = 0.0;
+
+    // Blocchi da 2 * nextPow2(m) fino a FFT_BLOCK_FACTOR * m: le serie corte usano il più piccolo sufficiente
+    std::vector<Block> blocks;
+};
+
+#endif // FFTDISTANCE_H
@@ -0,0 +1,314 @@
+#ifndef FLATSTORAGE_H
+#define FLATSTORAGE_H
+
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include "AlignedAllocator.h"
+
+// Disposizione in memoria del buffer contiguo:
+// - RowMajor:    ogni serie è contigua (stride 1), inizio allineato a 64 byte
+// - ColumnMajor: i valori di tutte le serie allo stesso istante sono contigui
+// - Tiled:       blocchi di tileWidth serie, all'interno del blocco per istante
+enum class StorageLayout
+{
+    RowMajor,
+    ColumnMajor,
+    Tiled
+};
+
+inline std::string storageLayoutName(StorageLayout layout)
+{
+    switch (layout)
+    {
+    case StorageLayout::RowMajor:
+        return "row_major";
+    case StorageLayout::ColumnMajor:
+        return "column_major";
+    case StorageLayout::Tiled:
+        return "tiled";
+    }
+    return "unknown";
+}
+
+inline bool parseStorageLayout(const std::string &name, StorageLayout &layout)
+{
+    for (StorageLayout candidate : {StorageLayout::RowMajor, StorageLayout::ColumnMajor, StorageLayout::Tiled})
+    {
+        if (storageLayoutName(candidate) == name)
+        {
+            layout = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Buffer unico allineato che contiene l'intero dataset. La serie i inizia a
+// getSeriesData(i) e l'istante t si trova a getSeriesData(i)[t * getStride()].
+// Il buffer può anche essere esterno e in sola lettura (es. un file mappato
+// con mmap): alla prima modifica viene copiato in un buffer proprio.
+template <typename T>
+class FlatStorage
+{
+public:
+    static constexpr size_t CACHE_LINE = 64;
+    static constexpr size_t ELEMENTS_PER_LINE = CACHE_LINE / sizeof(T) > 0 ? CACHE_LINE / sizeof(T) : 1;
+
+    explicit FlatStorage(StorageLayout layout = StorageLayout::RowMajor,
+                         size_t tileWidth = ELEMENTS_PER_LINE)
+        : layout(layout), tileWidth(tileWidth > 0 ? tileWidth : ELEMENTS_PER_LINE) {}
+
+    // Vista senza copia su un buffer esterno con la geometria scritta da un
+    // altro FlatStorage (vedi getRowCapacity, getColumnCapacity, getOffset).
+    // owner mantiene valido il buffer finché esiste una copia della vista
+    static FlatStorage wrap(StorageLayout layout, size_t tileWidth, const T *data, size_t numElements,
+                            std::vector<size_t> offsets, std::vector<size_t> lengths,
+                            size_t rowCapacity, size_t columnCapacity,
+                            std::shared_ptr<const void> owner)
+    {
+        FlatStorage storage(layout, tileWidth);
+        storage.external = data;
+        storage.externalSize = numElements;
+        storage.owner = std::move(owner);
+        storage.offsets = std::move(offsets);
+        storage.seriesLengths = std::move(lengths);
+        storage.rowCapacity = rowCapacity;
+        storage.columnCapacity = columnCapacity;
+        if (layout == StorageLayout::Tiled && rowCapacity > 0)
+        {
+            storage.numTiles = numElements / (rowCapacity * storage.tileWidth);
+        }
+        for (size_t length : storage.seriesLengths)
+        {
+            storage.maxLength = std::max(storage.maxLength, length);
+        }
+        return storage;
+    }
+
+    // Prealloca lo spazio per evitare riorganizzazioni durante il caricamento
+    void reserve(size_t numSeriesHint, size_t maxLengthHint)
+    {
+        materialize();
+        if (layout == StorageLayout::RowMajor)
+        {
+            buffer.reserve(numSeriesHint * roundUp(maxLengthHint));
+            offsets.reserve(numSeriesHint);
+        }
+        else if (numSeriesHint > seriesCapacity() || maxLengthHint > rowCapacity)
+        {
+            relayout(std::max(numSeriesHint, seriesCapacity()),
+                     std::max(maxLengthHint, rowCapacity));
+        }
+        seriesLengths.reserve(numSeriesHint);
+    }
+
+    template <typename U>
+    void addSeries(const U *values, size_t length)
+    {
+        materialize();
+        size_t index = seriesLengths.size();
+
+        if (layout == StorageLayout::RowMajor)
+        {
+            size_t offset = buffer.size();
+            buffer.resize(offset + roundUp(length));
+            std::copy(values, values + length, buffer.begin() + offset);
+            offsets.push_back(offset);
+            seriesLengths.push_back(length);
+            maxLength = std::max(maxLength, length);
+            return;
+        }
+
+        if (index >= seriesCapacity() || length > rowCapacity)
+        {
+            size_t newSeries = index >= seriesCapacity() ? std::max<size_t>(2 * seriesCapacity(), index + 1) : seriesCapacity();
+            size_t newRows = length > rowCapacity ? std::max(2 * rowCapacity, length) : rowCapacity;
+            relayout(newSeries, newRows);
+        }
+
+        seriesLengths.push_back(length);
+        offsets.push_back(offsetOf(index));
+        maxLength = std::max(maxLength, length);
+
+        T *dst = buffer.data() + offsets[index];
+        size_t stride = getStride();
+        for (size_t t = 0; t < length; ++t)
+        {
+            dst[t * stride] = values[t];
+        }
+    }
+
+    template <typename U>
+    void addSeries(const std::vector<U> &values)
+    {
+        addSeries(values.data(), values.size());
+    }
+
+    // Sostituisce il contenuto con serie (a zero) delle lunghezze date, da
+    // riempire poi tramite getMutableSeriesData anche da più thread in parallelo
+    void allocate(const std::vector<size_t> &lengths)
+    {
+        external = nullptr;
+        externalSize = 0;
+        owner.reset();
+        buffer.clear();
+        offsets.clear();
+        seriesLengths.clear();
+        maxLength = 0;
+        rowCapacity = columnCapacity = numTiles = 0;
+
+        for (size_t length : lengths)
+        {
+            maxLength = std::max(maxLength, length);
+        }
+
+        if (layout == StorageLayout::RowMajor)
+        {
+            size_t total = 0;
+            offsets.reserve(lengths.size());
+            for (size_t length : lengths)
+            {
+                offsets.push_back(total);
+                total += roundUp(length);
+            }
+            buffer.assign(total, T());
+        }
+        else
+        {
+            relayout(lengths.size(), maxLength);
+            offsets.reserve(lengths.size());
+            for (size_t i = 0; i < lengths.size(); ++i)
+            {
+                offsets.push_back(offsetOf(i));
+            }
+        }
+
+        seriesLengths = lengths;
+    }
+
+    T *getMutableSeriesData(size_t seriesIndex)
+    {
+        materialize();
+        return buffer.data() + offsets[seriesIndex];
+    }
+
+    size_t getNumSeries() const { return seriesLengths.size(); }
+    size_t getSeriesLength(size_t seriesIndex) const { return seriesLengths[seriesIndex]; }
+    size_t getMaxLength() const { return maxLength; }
+    StorageLayout getLayout() const { return layout; }
+
+    // Distanza (in elementi) tra due istanti consecutivi della stessa serie
+    size_t getStride() const
+    {
+        switch (layout)
+        {
+        case StorageLayout::ColumnMajor:
+            return columnCapacity;
+        case StorageLayout::Tiled:
+            return tileWidth;
+        default:
+            return 1;
+        }
+    }
+
+    const T *getSeriesData(size_t seriesIndex) const { return data() + offsets[seriesIndex]; }
+    const T *data() const { return external != nullptr ? external : buffer.data(); }
+    size_t size() const { return external != nullptr ? externalSize : buffer.size(); }
+    size_t sizeInBytes() const { return size() * sizeof(T); }
+    bool isExternal() const { return external != nullptr; }
+
+    // Geometria del buffer, necessaria per ricostruire la vista con wrap()
+    size_t getTileWidth() const { return tileWidth; }
+    size_t getRowCapacity() const { return rowCapacity; }
+    size_t getColumnCapacity() const { return columnCapacity; }
+    size_t getOffset(size_t seriesIndex) const { return offsets[seriesIndex]; }
+
+    inline const T &at(size_t seriesIndex, size_t timeIndex) const
+    {
+        return data()[offsets[seriesIndex] + timeIndex * getStride()];
+    }
+
+private:
+    // Copia il buffer esterno in uno proprio prima di una modifica
+    void materialize()
+    {
+        if (external == nullptr)
+            return;
+
+        buffer.assign(external, external + externalSize);
+        external = nullptr;
+        externalSize = 0;
+        owner.reset();
+    }
+
+    static size_t roundUp(size_t n)
+    {
+        return (n + ELEMENTS_PER_LINE - 1) / ELEMENTS_PER_LINE * ELEMENTS_PER_LINE;
+    }
+
+    size_t seriesCapacity() const
+    {
+        if (layout == StorageLayout::ColumnMajor)
+            return columnCapacity;
+        return numTiles * tileWidth;
+    }
+
+    size_t offsetOf(size_t seriesIndex) const
+    {
+        if (layout == StorageLayout::ColumnMajor)
+            return seriesIndex;
+        return (seriesIndex / tileWidth) * rowCapacity * tileWidth + seriesIndex % tileWidth;
+    }
+
+    // Ricostruisce il buffer con capacità maggiori (crescita geometrica,
+    // costo ammortizzato costante per elemento inserito)
+    void relayout(size_t newSeriesCapacity, size_t newRowCapacity)
+    {
+        size_t oldStride = getStride();
+        std::vector<size_t> oldOffsets = offsets;
+        AlignedVector<T> oldBuffer;
+        oldBuffer.swap(buffer);
+
+        rowCapacity = roundUp(newRowCapacity);
+        if (layout == StorageLayout::ColumnMajor)
+        {
+            columnCapacity = roundUp(newSeriesCapacity);
+            buffer.assign(rowCapacity * columnCapacity, T());
+        }
+        else
+        {
+            numTiles = (newSeriesCapacity + tileWidth - 1) / tileWidth;
+            buffer.assign(numTiles * rowCapacity * tileWidth, T());
+        }
+
+        size_t stride = getStride();
+        for (size_t i = 0; i < seriesLengths.size(); ++i)
+        {
+            offsets[i] = offsetOf(i);
+            const T *src = oldBuffer.data() + oldOffsets[i];
+            T *dst = buffer.data() + offsets[i];
+            for (size_t t = 0; t < seriesLengths[i]; ++t)
+            {
+                dst[t * stride] = src[t * oldStride];
+            }
+        }
+    }
+
+    StorageLayout layout;
+    size_t tileWidth;
+    AlignedVector<T> buffer;
+    std::vector<size_t> offsets;
+    std::vector<size_t> seriesLengths;
+    size_t maxLength = 0;
+    size_t rowCapacity = 0;
+    size_t columnCapacity = 0;
+    size_t numTiles = 0;
+
+    const T *external = nullptr;
+    size_t externalSize = 0;
+    std::shared_ptr<const void> owner;
+};
+
+#endif // FLATSTORAGE_H
@@ -0,0 +1,66 @@
+#ifndef LOWERBOUNDS_H
+#define LOWERBOUNDS_H
+
+#include <cstddef>
+#include <vector>
+#include "AlignedAllocator.h"
+#include "SadKernels.h"
+
+struct SearchStats;
+
+// Buffer riutilizzati tra le serie dallo stesso thread
+struct CascadeScratch
+{
+    AlignedVector<double> prefix;
+    AlignedVector<double> prefixMin;
+    AlignedVector<double> prefixMax;
+    AlignedVector<double> suffixMin;
+    AlignedVector<double> suffixMax;
+
+    // Efficacia dell'envelope di gruppo nella ricerca corrente
+    size_t envelopeAttempts = 0;
+    size_t envelopeHits = 0;
+};
+
+// Cascata di lower bound per la SAD, costruita una volta per query.
+// Livelli, dal più economico:
+//   0. envelope della serie: sum_k dist(q_k, [min, max]) scarta l'intera serie
+//   1. PAA: sum_seg |sum(s_seg) - sum(q_seg)| <= SAD (disuguaglianza triangolare),
+//      O(m / PAA_SEGMENT) per finestra con le somme prefisse della serie
+//   2. envelope di gruppo (stile LB_Keogh): per ogni k il range dei valori visti
+//      dalle GROUP_SIZE finestre del gruppo, O(m) per l'intero gruppo
+//   3. SAD esatta con early abandon sui gruppi sopravvissuti
+class LowerBoundCascade
+{
+public:
+    static constexpr size_t GROUP_SIZE = 16;
+    static constexpr size_t PAA_SEGMENT = 8;
+    static constexpr size_t PAA_CHECK = 2;
+
+    // L'envelope di gruppo resta attivo se scarta almeno 1 gruppo su
+    // ENVELOPE_MIN_HIT_RATIO dopo i primi ENVELOPE_PROBE tentativi
+    static constexpr size_t ENVELOPE_PROBE = 64;
+    static constexpr size_t ENVELOPE_MIN_HIT_RATIO = 8;
+
+    LowerBoundCascade(const double *query, size_t queryLength);
+
+    // Livello 0: limite inferiore della SAD di ogni finestra di una serie con valori in [seriesMin, seriesMax]
+    double envelopeBound(double seriesMin, double seriesMax) const;
+
+    // Livelli 1-3 sugli offset [0, numOffsets): il risultato è esatto se il
+    // minimo reale è <= threshold, altrimenti è la SAD di una finestra completata
+    // (o max() se nessuna è sopravvissuta)
+    double minSad(const SadKernel &kernel, const double *series, size_t numOffsets,
+                  double threshold, CascadeScratch &scratch, SearchStats &stats) const;
+
+private:
+    bool paaPrunesGroup(const double *prefix, size_t count, double limit) const;
+    double groupEnvelopeBound(const double *series, size_t count, double threshold,
+                              CascadeScratch &scratch) const;
+
+    const double *query;
+    size_t queryLength;
+    std::vector<double> segmentSums;
+};
+
+#endif // LOWERBOUNDS_H
@@ -0,0 +1,65 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// File mappato in sola lettura, rilasciato con l'ultimo riferimento
+class MappedFile
+{
+public:
+    // nullptr se il file non esiste o non può essere mappato
+    static std::shared_ptr<MappedFile> open(const std::string &filename)
+    {
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            return nullptr;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0)
+        {
+            close(fd);
+            return nullptr;
+        }
+
+        size_t length = static_cast<size_t>(info.st_size);
+        void *address = nullptr;
+        if (length > 0)
+        {
+            address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+
+        if (address == MAP_FAILED)
+            return nullptr;
+
+        return std::shared_ptr<MappedFile>(new MappedFile(address, length));
+    }
+
+    ~MappedFile()
+    {
+        if (address != nullptr)
+        {
+            munmap(address, length);
+        }
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *bytes() const { return static_cast<const char *>(address); }
+    size_t size() const { return length; }
+
+private:
+    MappedFile(void *address, size_t length) : address(address), length(length) {}
+
+    void *address;
+    size_t length;
+};
+
+#endif // MAPPEDFILE_H
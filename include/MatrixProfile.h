@@ -0,0 +1,69 @@
+#ifndef MATRIXPROFILE_H
+#define MATRIXPROFILE_H
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+#include "TimeSeriesAoS.h"
+#include "TimeSeriesSoA.h"
+#include "TopK.h"
+
+// Matrix profile di tutte le finestre di lunghezza windowLength del dataset.
+// Le finestre sono numerate globalmente: quelle della serie i occupano
+// [windowOffsets[i], windowOffsets[i + 1])
+struct MatrixProfileResult
+{
+    size_t windowLength = 0;
+    std::vector<size_t> windowOffsets;
+
+    // Distanza ZNormEuclidean (quadrata, come SearchEngine) dal vicino più
+    // prossimo e indice globale del vicino; max() e NO_NEIGHBOR se non ce n'è
+    std::vector<double> distances;
+    std::vector<size_t> neighbors;
+
+    static constexpr size_t NO_NEIGHBOR = std::numeric_limits<size_t>::max();
+
+    size_t numWindows() const { return distances.size(); }
+    size_t numSeries() const { return windowOffsets.empty() ? 0 : windowOffsets.size() - 1; }
+
+    // Serie e offset della finestra globale (sad = distanza dal vicino)
+    Match window(size_t globalIndex) const;
+};
+
+// Coppia di finestre più simili (motif) del profilo
+struct Motif
+{
+    Match window;
+    Match neighbor;
+};
+
+// Matrix profile in stile STOMP/SCAMP: i prodotti scalari tra le finestre
+// sono aggiornati in O(1) lungo le diagonali della matrice delle distanze
+//   QT[i+1][j+1] = QT[i][j] - a[i] b[j] + a[i+m] b[j+m]
+// e la distanza z-normalizzata si ricava da QT, media e deviazione standard.
+// La matrice è divisa in tile di TILE_DIAGONALS diagonali x TILE_ROWS righe,
+// distribuiti dinamicamente tra i thread; ogni tile ricalcola i prodotti
+// scalari iniziali (limitando l'errore accumulato) e accumula i minimi delle
+// sue righe e colonne in buffer locali, fusi nel profilo condiviso una volta
+// per tile sotto lock a blocchi: nessuna sincronizzazione nel loop interno.
+class MatrixProfile
+{
+public:
+    static constexpr size_t TILE_DIAGONALS = 64;
+    static constexpr size_t TILE_ROWS = 1024;
+
+    // Finestre della stessa serie a distanza < exclusionZone sono match banali
+    static size_t exclusionZone(size_t windowLength) { return (windowLength + 3) / 4; }
+
+    // acrossSeries = false: solo self-join di ciascuna serie;
+    // true: il vicino è cercato tra le finestre di tutte le serie
+    static MatrixProfileResult computeSoA(const TimeSeriesSoA &dataset, size_t windowLength, bool acrossSeries = true);
+    static MatrixProfileResult computeAoS(const TimeSeriesAoS &dataset, size_t windowLength, bool acrossSeries = true);
+
+    // Le k coppie più vicine e le k finestre più lontane dal proprio vicino
+    // (discord), senza finestre sovrapposte a quelle già scelte
+    static std::vector<Motif> motifs(const MatrixProfileResult &profile, size_t k);
+    static std::vector<Match> discords(const MatrixProfileResult &profile, size_t k);
+};
+
+#endif // MATRIXPROFILE_H
@@ -0,0 +1,16 @@
+#ifndef MEMORYUSAGE_H
+#define MEMORYUSAGE_H
+
+#include <cstddef>
+
+// Memoria residente del processo (0 se non disponibile sulla piattaforma)
+namespace MemoryUsage
+{
+    // Picco dall'avvio del processo (getrusage)
+    size_t peakRssBytes();
+
+    // Valore attuale (/proc/self/statm)
+    size_t currentRssBytes();
+}
+
+#endif // MEMORYUSAGE_H
@@ -0,0 +1,80 @@
+#ifndef NUMAPLACEMENT_H
+#define NUMAPLACEMENT_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "TimeSeriesAoS.h"
+#include "TimeSeriesSoA.h"
+
+// Distribuzione delle pagine del dataset tra i nodi NUMA
+// - None:       pagine dove le ha toccate il caricamento (di solito un nodo)
+// - FirstTouch: copia parallela statica, ogni thread tocca per primo la sua
+//               fetta contigua del buffer (per i layout row-major è il blocco
+//               di serie che gli assegnerebbe un loop outer statico)
+// - Interleave: pagine alternate tra tutti i nodi (mbind MPOL_INTERLEAVE)
+enum class NumaPolicy
+{
+    None,
+    FirstTouch,
+    Interleave
+};
+
+inline std::string numaPolicyName(NumaPolicy policy)
+{
+    switch (policy)
+    {
+    case NumaPolicy::None:
+        return "none";
+    case NumaPolicy::FirstTouch:
+        return "first_touch";
+    case NumaPolicy::Interleave:
+        return "interleave";
+    }
+    return "unknown";
+}
+
+inline bool parseNumaPolicy(const std::string &name, NumaPolicy &policy)
+{
+    for (NumaPolicy candidate : {NumaPolicy::None, NumaPolicy::FirstTouch, NumaPolicy::Interleave})
+    {
+        if (numaPolicyName(candidate) == name)
+        {
+            policy = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Affinità dei thread OpenMP, con la semantica di OMP_PLACES / OMP_PROC_BIND
+// ma applicabile a runtime (libgomp legge le variabili d'ambiente solo
+// all'avvio del processo): places "threads", "cores" o "numa_domains",
+// bind "close" o "spread"; bind vuoto lascia l'affinità al runtime
+struct ThreadAffinity
+{
+    std::string places = "cores";
+    std::string bind;
+};
+
+class NumaPlacement
+{
+public:
+    // Nodi NUMA online (1 se l'informazione non è disponibile)
+    static size_t numNodes();
+
+    // Ridistribuisce le pagine del dataset secondo policy e restituisce la
+    // policy effettivamente applicata: None su macchine con un solo nodo o
+    // se la piattaforma non la supporta (il dataset resta invariato)
+    static NumaPolicy place(TimeSeriesSoA &dataset, NumaPolicy policy);
+    static NumaPolicy place(TimeSeriesAoS &dataset, NumaPolicy policy);
+
+    // Lega i thread del prossimo team (omp_get_max_threads) ai place scelti;
+    // false se affinity.bind è vuoto o non valido o se il binding fallisce
+    static bool bindThreads(const ThreadAffinity &affinity);
+
+    // CPU (id logici) di ciascun place, nell'ordine usato da bindThreads
+    static std::vector<std::vector<int>> places(const std::string &kind);
+};
+
+#endif // NUMAPLACEMENT_H
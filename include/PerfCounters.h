@@ -0,0 +1,76 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Contatori hardware letti con perf_event_open (solo user space, quindi
+// sufficienti perf_event_paranoid <= 2 e nessun privilegio)
+enum class PerfEvent
+{
+    Cycles,
+    Instructions,
+    L1dMisses,
+    LlcMisses,
+    BranchMisses
+};
+
+constexpr size_t NUM_PERF_EVENTS = 5;
+
+std::string perfEventName(PerfEvent event);
+
+// Valori sommati su thread e ripetizioni; available[e] è false se il
+// contatore non esiste sulla macchina (es. eventi di cache in una VM)
+struct PerfSample
+{
+    std::array<uint64_t, NUM_PERF_EVENTS> values{};
+    std::array<bool, NUM_PERF_EVENTS> available{};
+
+    bool has(PerfEvent event) const { return available[static_cast<size_t>(event)]; }
+    uint64_t get(PerfEvent event) const { return values[static_cast<size_t>(event)]; }
+
+    bool any() const
+    {
+        for (bool open : available)
+        {
+            if (open)
+                return true;
+        }
+        return false;
+    }
+};
+
+// Misura di una regione: start() apre i contatori su ogni thread del prossimo
+// team OpenMP (omp_get_max_threads), stop() li legge, li somma a total() e
+// li chiude. Con la raccolta disabilitata start e stop non fanno nulla.
+// I conteggi includono l'attesa attiva dei thread del team tra le regioni.
+class PerfCounters
+{
+public:
+    // Abilita la raccolta se perf_event_open è utilizzabile; altrimenti resta
+    // disabilitata e reason (se non nullo) spiega perché
+    static bool setEnabled(bool enabled, std::string *reason = nullptr);
+    static bool isEnabled();
+
+    PerfCounters() = default;
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    void start();
+    void stop();
+
+    const PerfSample &total() const { return sum; }
+
+private:
+    void closeAll();
+
+    std::vector<std::array<int, NUM_PERF_EVENTS>> descriptors;
+    PerfSample sum;
+};
+
+#endif // PERFCOUNTERS_H
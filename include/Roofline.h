@@ -0,0 +1,32 @@
+#ifndef ROOFLINE_H
+#define ROOFLINE_H
+
+#include <cstddef>
+#include "SadKernels.h"
+
+// Limiti della macchina per il modello roofline, misurati con il numero di
+// thread OpenMP corrente (omp_get_max_threads)
+struct MachineCeilings
+{
+    int threads = 0;
+    size_t arrayBytes = 0;           // dimensione di ciascun vettore dei test di banda
+    double triadBytesPerSecond = 0.0; // a[i] = b[i] + s * c[i], 24 byte per elemento (convenzione STREAM)
+    double readBytesPerSecond = 0.0;  // somma di un vettore, 8 byte per elemento
+    double sadTermsPerSecond = 0.0;   // termini |s - q| del kernel SAD su dati residenti in L1
+};
+
+class Roofline
+{
+public:
+    // Operazioni in virgola mobile per termine SAD: sottrazione, valore assoluto, somma
+    static constexpr double FLOPS_PER_SAD_TERM = 3.0;
+
+    // Banda sostenibile (migliore di alcune ripetizioni, come STREAM) e picco
+    // del kernel; arrayBytes = 0 usa defaultArrayBytes()
+    static MachineCeilings measure(const SadKernel &kernel, size_t arrayBytes = 0);
+
+    // 4 volte la cache di ultimo livello (tra 32 e 256 MiB), perché i vettori non ci stiano
+    static size_t defaultArrayBytes();
+};
+
+#endif // ROOFLINE_H
@@ -0,0 +1,81 @@
+#ifndef SADKERNELS_H
+#define SADKERNELS_H
+
+#include <cstddef>
+#include <string>
+#include "DistanceMetrics.h"
+
+enum class SimdIsa
+{
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+// Interfaccia comune dei kernel SAD. Tutti i kernel lavorano su serie
+// contigue e calcolano più offset della finestra contemporaneamente
+// (un offset per lane); la somma su k segue lo stesso ordine del loop
+// scalare, quindi i risultati sono identici bit a bit tra le varianti.
+// La stessa interfaccia è usata dalle altre metriche (SadKernels::get con
+// DistanceMetric): in quel caso "SAD" indica la distanza della metrica.
+struct SadKernel
+{
+    SimdIsa isa;
+    const char *name;
+
+    // acc[j] += sum_k |series[j + k] - query[k]| per j in [0, numOffsets),
+    // aggiungendo i termini in ordine di k a partire dal valore in acc[j].
+    // nullptr per le metriche normalizzate (servono le statistiche della finestra intera)
+    void (*accumulateSad)(const double *series, const double *query,
+                          size_t queryLength, size_t numOffsets, double *acc);
+
+    // out[j] = sum_k |series[j + k] - query[k]| per j in [0, numOffsets)
+    void (*slidingSad)(const double *series, const double *query,
+                       size_t queryLength, size_t numOffsets, double *out);
+
+    // min_j sum_k |series[j + k] - query[k]| per j in [0, numOffsets)
+    double (*minSad)(const double *series, const double *query,
+                     size_t queryLength, size_t numOffsets);
+
+    // Come minSad, ma un gruppo di offset viene abbandonato appena tutte le
+    // somme parziali superano la soglia (threshold o il minimo già trovato).
+    // Il risultato è esatto se il minimo reale è <= threshold; in ogni caso è
+    // la SAD di una finestra completata (o max() se sono state tutte abbandonate).
+    // evaluatedTerms, se non nullo, viene incrementato dei termini calcolati.
+    double (*minSadEarlyAbandon)(const double *series, const double *query,
+                                 size_t queryLength, size_t numOffsets,
+                                 double threshold, size_t *evaluatedTerms);
+
+    // Come slidingSad con early abandon a soglia fissa: out[j] è la SAD esatta
+    // se <= threshold, altrimenti un valore parziale comunque > threshold
+    void (*slidingSadEarlyAbandon)(const double *series, const double *query,
+                                   size_t queryLength, size_t numOffsets,
+                                   double threshold, double *out, size_t *evaluatedTerms);
+};
+
+class SadKernels
+{
+public:
+    // ISA migliore supportata dalla CPU (CPUID)
+    static SimdIsa detectIsa();
+
+    // Kernel attualmente in uso (selezionato al primo utilizzo da detectIsa)
+    static const SadKernel &active();
+
+    // Forza un kernel specifico; false se la CPU non lo supporta
+    static bool setActive(SimdIsa isa);
+
+    static bool isSupported(SimdIsa isa);
+    static const SadKernel &get(SimdIsa isa);
+
+    // Kernel specializzato per la metrica, con la stessa ISA (DistanceKernels.cpp).
+    // Per ZNormEuclidean la query passata ai kernel deve essere già z-normalizzata
+    static const SadKernel &get(SimdIsa isa, DistanceMetric metric);
+    static const SadKernel &active(DistanceMetric metric);
+
+    static std::string isaName(SimdIsa isa);
+    static bool parseIsa(const std::string &name, SimdIsa &isa);
+};
+
+#endif // SADKERNELS_H
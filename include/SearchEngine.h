@@ -3,34 +3,298 @@
 
 #include "TimeSeries.h"
 #include <vector>
+#include <algorithm>
 #include <utility>
 #include <omp.h>
 #include "TimeSeriesAoS.h"
 #include "TimeSeriesSoA.h"
+#include "TopK.h"
+#include "DistanceMetrics.h"
+#include "CompactDataset.h"
+#include "DatasetIndex.h"
+
+// Contatori di lavoro: termini |s - q| possibili e calcolati davvero
+struct SearchStats
+{
+    size_t totalTerms = 0;
+    size_t evaluatedTerms = 0;
+
+    // Cascata di lower bound: candidati scartati da ciascun livello
+    size_t seriesTotal = 0;
+    size_t seriesPrunedEnvelope = 0;
+    size_t windowsTotal = 0;
+    size_t windowsPrunedSeries = 0;
+    size_t windowsPrunedPaa = 0;
+    size_t windowsPrunedEnvelope = 0;
+    size_t windowsExact = 0;
+
+    // Finestre calcolate con il motore FFT (FftDistance.h)
+    size_t windowsFft = 0;
+
+    // Ricerca su CompactDataset: finestre stimate sulla copia compatta e
+    // serie ricalcolate in double per il re-rank
+    size_t windowsCompact = 0;
+    size_t seriesReranked = 0;
+
+    // Ricerca con DatasetIndex: finestre dei blocchi scartati dal lower bound dell'indice
+    size_t windowsPrunedIndex = 0;
+
+    // Ricerca approssimata: serie rifinite dopo la fase grossolana
+    size_t seriesRefined = 0;
+
+    double prunedFraction() const
+    {
+        return totalTerms > 0 ? 1.0 - static_cast<double>(evaluatedTerms) / totalTerms : 0.0;
+    }
+
+    SearchStats &operator+=(const SearchStats &other)
+    {
+        totalTerms += other.totalTerms;
+        evaluatedTerms += other.evaluatedTerms;
+        seriesTotal += other.seriesTotal;
+        seriesPrunedEnvelope += other.seriesPrunedEnvelope;
+        windowsTotal += other.windowsTotal;
+        windowsPrunedSeries += other.windowsPrunedSeries;
+        windowsPrunedPaa += other.windowsPrunedPaa;
+        windowsPrunedEnvelope += other.windowsPrunedEnvelope;
+        windowsExact += other.windowsExact;
+        windowsFft += other.windowsFft;
+        windowsCompact += other.windowsCompact;
+        seriesReranked += other.seriesReranked;
+        windowsPrunedIndex += other.windowsPrunedIndex;
+        seriesRefined += other.seriesRefined;
+        return *this;
+    }
+};
+
+// Tempo di lavoro effettivo di ciascun thread (varianti Collapsed e Tasks),
+// accumulato tra le chiamate: serve a verificare il bilanciamento del carico
+struct LoadBalance
+{
+    std::vector<double> busyMs;
+
+    // Rapporto tra il thread più carico e la media (1 = bilanciamento perfetto)
+    double imbalance() const
+    {
+        if (busyMs.empty())
+            return 1.0;
+        double total = 0.0;
+        double maxBusy = 0.0;
+        for (double busy : busyMs)
+        {
+            total += busy;
+            maxBusy = std::max(maxBusy, busy);
+        }
+        return total > 0.0 ? maxBusy * busyMs.size() / total : 1.0;
+    }
+};
+
+struct SearchOptions
+{
+    // Abbandona una finestra appena la SAD parziale supera il minimo della serie:
+    // sadValues e best match restano identici alla ricerca esaustiva
+    // (znorm_euclidean: a meno di arrotondamenti, vedi DistanceKernels.cpp)
+    bool earlyAbandon = false;
+
+    // Varianti outer: usa anche il miglior SAD globale, condiviso tra i thread.
+    // best match e relativo SAD restano identici (znorm_euclidean: a meno di
+    // arrotondamenti); per le serie che non possono battere il migliore
+    // sadValues contiene un limite superiore del minimo
+    bool shareGlobalBest = false;
+
+    // Pre-filtro con la cascata di lower bound (LowerBounds.h) davanti al kernel
+    // esatto; implica earlyAbandon. Con shareGlobalBest abilita anche lo scarto
+    // di intere serie tramite l'envelope [min, max]
+    bool lowerBounds = false;
+
+    // Metrica di distanza: sadValues contiene la distanza scelta al posto della
+    // SAD. La cascata di lower bound è definita solo per la SAD e viene ignorata
+    // con le altre metriche (early abandon resta valido per tutte)
+    DistanceMetric metric = DistanceMetric::Sad;
+
+    // Per SquaredEuclidean e ZNormEuclidean: le serie (o i tratti, nelle varianti
+    // inner) su cui l'FFT costa meno vengono calcolate con FftDistance, senza
+    // early abandon né lower bound. Ignorato con le altre metriche
+    DistanceEngine engine = DistanceEngine::Auto;
+
+    SearchStats *stats = nullptr;
+    LoadBalance *loadBalance = nullptr;
+};
+
+// Ricerca approssimata in due fasi:
+//   1. fase grossolana: in ogni serie solo gli offset multipli di stride,
+//      tenendo i refineCandidates migliori
+//   2. rifinitura: le serie migliori della fase 1 (refineFraction del totale,
+//      almeno minRefineSeries) vengono ricalcolate su tutti gli offset entro
+//      stride - 1 dai loro candidati, dalla più promettente
+// sadValues contiene la SAD di finestre effettivamente calcolate, quindi un
+// limite superiore del minimo esatto. stride = 1 e refineFraction = 1 danno
+// il risultato esatto.
+struct ApproximateOptions
+{
+    size_t stride = 8;
+    size_t refineCandidates = 2;
+    double refineFraction = 0.1;
+    size_t minRefineSeries = 16;
+
+    // > 0: la rifinitura si ferma allo scadere del budget (la fase 1 viene
+    // sempre completata), le serie non rifinite restano con la stima grossolana
+    double timeBudgetMs = 0.0;
+};
 
 class SearchEngine
 {
 public:
     static std::pair<std::vector<double>, size_t> searchSequentialSoA(
         const TimeSeriesSoA &dataset,
-        const TimeSeries &query);
+        const TimeSeries &query,
+        const SearchOptions &options = SearchOptions());
     static std::pair<std::vector<double>, size_t> searchSequentialAoS(
         const TimeSeriesAoS &dataset,
-        const TimeSeries &query);
+        const TimeSeries &query,
+        const SearchOptions &options = SearchOptions());
 
     static std::pair<std::vector<double>, size_t> searchParallelAoSOuter(
         const TimeSeriesAoS &dataset,
-        const TimeSeries &query);
+        const TimeSeries &query,
+        const SearchOptions &options = SearchOptions());
     static std::pair<std::vector<double>, size_t> searchParallelAoSInner(
         const TimeSeriesAoS &dataset,
-        const TimeSeries &query);
+        const TimeSeries &query,
+        const SearchOptions &options = SearchOptions());
 
     static std::pair<std::vector<double>, size_t> searchParallelSoAOuter(
         const TimeSeriesSoA &dataset,
-        const TimeSeries &query);
+        const TimeSeries &query,
+        const SearchOptions &options = SearchOptions());
     static std::pair<std::vector<double>, size_t> searchParallelSoAInner(
         const TimeSeriesSoA &dataset,
-        const TimeSeries &query);
+        const TimeSeries &query,
+        const SearchOptions &options = SearchOptions());
+
+    // Spazio (serie, offset) appiattito in blocchi bilanciati, indipendentemente
+    // da quante serie ci sono: una sola regione parallela, minimi per blocco e
+    // riduzione per serie senza sezioni critiche. Risultati identici bit a bit
+    // a Outer per sad, squared_euclidean e chebyshev; con znorm_euclidean a
+    // meno di arrotondamenti
+    static std::pair<std::vector<double>, size_t> searchParallelSoACollapsed(
+        const TimeSeriesSoA &dataset,
+        const TimeSeries &query,
+        const SearchOptions &options = SearchOptions());
+    static std::pair<std::vector<double>, size_t> searchParallelAoSCollapsed(
+        const TimeSeriesAoS &dataset,
+        const TimeSeries &query,
+        const SearchOptions &options = SearchOptions());
+
+    // Come Collapsed, ma con un costo stimato per blocco: le serie corte sono
+    // raggruppate, i blocchi sono eseguiti come task OpenMP dal più costoso,
+    // così serie di lunghezze molto diverse non lasciano una coda su pochi thread
+    static std::pair<std::vector<double>, size_t> searchParallelSoATasks(
+        const TimeSeriesSoA &dataset,
+        const TimeSeries &query,
+        const SearchOptions &options = SearchOptions());
+    static std::pair<std::vector<double>, size_t> searchParallelAoSTasks(
+        const TimeSeriesAoS &dataset,
+        const TimeSeries &query,
+        const SearchOptions &options = SearchOptions());
+
+    // SAD stimata sulla copia compatta (float32/int16/int8) del dataset, serie
+    // divise tra i thread. Con rerank le serie il cui intervallo di errore può
+    // contenere il minimo globale vengono ricalcolate in double su dataset:
+    // best match e relativo SAD sono identici alla ricerca in double, le altre
+    // serie restano stimate. Solo SAD: con altre metriche usa searchParallelSoAOuter
+    static std::pair<std::vector<double>, size_t> searchCompactSoA(
+        const CompactDataset &compact,
+        const TimeSeriesSoA &dataset,
+        const TimeSeries &query,
+        bool rerank = true,
+        const SearchOptions &options = SearchOptions());
+
+    // Ricerca esatta guidata da DatasetIndex: i blocchi di offset (uno per
+    // blocco dell'indice) sono visitati in ordine di lower bound e scartati
+    // quando il bound supera il miglior SAD già trovato; nei blocchi rimasti
+    // lavorano i kernel usuali. Best match e relativo SAD sono identici alla
+    // ricerca esaustiva; le serie scartate per intero hanno sadValues = max().
+    // Solo SAD: con altre metriche, o con un indice di un altro dataset, usa
+    // la variante outer
+    static std::pair<std::vector<double>, size_t> searchIndexedSoA(
+        const DatasetIndex &index,
+        const TimeSeriesSoA &dataset,
+        const TimeSeries &query,
+        const SearchOptions &options = SearchOptions());
+    static std::pair<std::vector<double>, size_t> searchIndexedAoS(
+        const DatasetIndex &index,
+        const TimeSeriesAoS &dataset,
+        const TimeSeries &query,
+        const SearchOptions &options = SearchOptions());
+
+    // N query in un solo passaggio sul dataset: le serie vengono divise in
+    // blocchi da BATCH_TILE_BYTES e ogni blocco, una volta in cache, viene
+    // confrontato con tutte le query. Un risultato per query, nello stesso
+    // formato e con gli stessi valori delle ricerche singole (anche con il
+    // motore FFT, scelto per serie come in Outer)
+    static std::vector<std::pair<std::vector<double>, size_t>> searchBatchSoA(
+        const TimeSeriesSoA &dataset,
+        const std::vector<TimeSeries> &queries,
+        const SearchOptions &options = SearchOptions());
+    static std::vector<std::pair<std::vector<double>, size_t>> searchBatchAoS(
+        const TimeSeriesAoS &dataset,
+        const std::vector<TimeSeries> &queries,
+        const SearchOptions &options = SearchOptions());
+
+    // Top-K finestre (serie, offset, SAD) sull'intero dataset, ordinate dalla
+    // migliore. Serie divise tra i thread, ognuno con il proprio heap limitato;
+    // il K-esimo SAD (locale o condiviso con shareGlobalBest) fa da soglia di
+    // early abandon, quindi il risultato è identico a una ricerca esaustiva
+    // (znorm_euclidean: a meno di arrotondamenti)
+    static std::vector<Match> searchTopKSoA(
+        const TimeSeriesSoA &dataset,
+        const TimeSeries &query,
+        size_t k,
+        const SearchOptions &options = SearchOptions());
+    static std::vector<Match> searchTopKAoS(
+        const TimeSeriesAoS &dataset,
+        const TimeSeries &query,
+        size_t k,
+        const SearchOptions &options = SearchOptions());
+
+    // Top-K finestre di ciascuna serie
+    static std::vector<std::vector<Match>> searchTopKPerSeriesSoA(
+        const TimeSeriesSoA &dataset,
+        const TimeSeries &query,
+        size_t k,
+        const SearchOptions &options = SearchOptions());
+    static std::vector<std::vector<Match>> searchTopKPerSeriesAoS(
+        const TimeSeriesAoS &dataset,
+        const TimeSeries &query,
+        size_t k,
+        const SearchOptions &options = SearchOptions());
+
+    // Ricerca approssimata (ApproximateOptions), serie divise tra i thread
+    static std::pair<std::vector<double>, size_t> searchApproximateSoA(
+        const TimeSeriesSoA &dataset,
+        const TimeSeries &query,
+        const ApproximateOptions &approximate = ApproximateOptions(),
+        const SearchOptions &options = SearchOptions());
+    static std::pair<std::vector<double>, size_t> searchApproximateAoS(
+        const TimeSeriesAoS &dataset,
+        const TimeSeries &query,
+        const ApproximateOptions &approximate = ApproximateOptions(),
+        const SearchOptions &options = SearchOptions());
+
+    // Frazione delle k serie migliori secondo reference (minimo per serie, a
+    // parità l'indice più basso) presenti anche tra le k migliori di candidate
+    static double recallAtK(const std::vector<double> &reference, const std::vector<double> &candidate, size_t k);
+
+    // Sceglie i parametri più veloci (tempo misurato sulle query campione) con
+    // recall@k media >= recallTarget rispetto a searchSequentialSoA; se nessuna
+    // combinazione la raggiunge restituisce quella esatta (stride 1, tutte le serie)
+    static ApproximateOptions calibrateApproximateSoA(
+        const TimeSeriesSoA &dataset,
+        const std::vector<TimeSeries> &queries,
+        double recallTarget,
+        size_t k = 1,
+        const SearchOptions &options = SearchOptions());
 };
 
 #endif // SEARCHENGINE_H
\ No newline at end of file
@@ -0,0 +1,52 @@
+#ifndef SERIESVIEW_H
+#define SERIESVIEW_H
+
+#include <cstddef>
+#include "AlignedAllocator.h"
+
+// Vista non proprietaria (simile a std::span) su una serie memorizzata nel
+// buffer del dataset: nessuna allocazione né copia, solo puntatore + stride
+template <typename T>
+class SeriesView
+{
+public:
+    SeriesView(const T *data, size_t length, size_t stride = 1)
+        : ptr(data), length(length), step(stride) {}
+
+    inline const T &operator[](size_t index) const { return ptr[index * step]; }
+
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+    const T *data() const { return ptr; }
+    size_t stride() const { return step; }
+    bool isContiguous() const { return step == 1; }
+
+    // Sotto-vista di count elementi a partire da begin
+    SeriesView slice(size_t begin, size_t count) const { return SeriesView(ptr + begin * step, count, step); }
+
+private:
+    const T *ptr;
+    size_t length;
+    size_t step;
+};
+
+// Puntatore contiguo ai valori della serie, richiesto dai kernel SIMD: se la
+// vista ha stride 1 punta direttamente al buffer del dataset, altrimenti i
+// valori vengono raccolti in scratch (riutilizzato tra le serie)
+template <typename T>
+inline const double *contiguousValues(const SeriesView<T> &series, AlignedVector<double> &scratch)
+{
+    static_assert(sizeof(T) == sizeof(double), "series elements must wrap a single double");
+
+    if (series.isContiguous())
+        return reinterpret_cast<const double *>(series.data());
+
+    scratch.resize(series.size());
+    for (size_t t = 0; t < series.size(); ++t)
+    {
+        scratch[t] = series[t];
+    }
+    return scratch.data();
+}
+
+#endif // SERIESVIEW_H
@@ -0,0 +1,75 @@
+#ifndef STREAMINGSEARCH_H
+#define STREAMINGSEARCH_H
+
+#include <atomic>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "AlignedAllocator.h"
+#include "SadKernels.h"
+#include "SearchEngine.h"
+#include "TimeSeries.h"
+#include "TopK.h"
+
+// Ricerca incrementale su serie che ricevono nuovi campioni: ogni append
+// valuta solo gli offset delle finestre completate dai nuovi campioni
+// (O(queryLength) per campione) e aggiorna il best match della serie e
+// quello globale. Il risultato è identico bit a bit a SearchEngine sulla serie
+// completa per sad, squared_euclidean e chebyshev; con znorm_euclidean
+// coincide a meno di arrotondamenti.
+class StreamingSearch
+{
+public:
+    explicit StreamingSearch(const TimeSeries &query, size_t numSeries = 0,
+                             const SearchOptions &options = SearchOptions());
+
+    // Non concorrente con append
+    size_t addSeries();
+    size_t getNumSeries() const { return series.size(); }
+    size_t getQueryLength() const { return queryLength; }
+
+    // Append su serie diverse possono avvenire da thread diversi in parallelo;
+    // sulla stessa serie vanno serializzati dal chiamante
+    void append(size_t seriesIndex, const double *values, size_t count);
+    void append(size_t seriesIndex, const std::vector<double> &values);
+
+    // Un blocco di campioni per ciascuna delle prime values.size() serie, in parallelo
+    void appendAll(const std::vector<std::vector<double>> &values);
+
+    // SAD max() finché la serie non ha almeno queryLength campioni
+    Match getBestMatch(size_t seriesIndex) const;
+    Match getBestMatch() const;
+
+    size_t getSamplesSeen(size_t seriesIndex) const;
+
+    // Stesso formato di SearchEngine::search*: SAD minimo per serie e indice migliore
+    std::pair<std::vector<double>, size_t> getResults() const;
+
+    SearchStats getStats() const;
+
+private:
+    struct SeriesState
+    {
+        // Ultimi campioni: history[0] è il campione numero historyStart della serie
+        AlignedVector<double> history;
+        size_t historyStart = 0;
+        size_t samplesSeen = 0;
+        double bestSad = std::numeric_limits<double>::max();
+        size_t bestOffset = 0;
+        SearchStats stats;
+    };
+
+    void publishBest(size_t seriesIndex, const SeriesState &state);
+
+    const SadKernel &kernel;
+    std::vector<double> query;
+    size_t queryLength;
+    SearchOptions options;
+    std::vector<SeriesState> series;
+
+    // Best globale: lettura senza lock, aggiornamento in sezione critica
+    std::atomic<double> globalBestSad;
+    Match globalBest;
+};
+
+#endif // STREAMINGSEARCH_H
@@ -0,0 +1,52 @@
+#ifndef SYNTHETICGENERATOR_H
+#define SYNTHETICGENERATOR_H
+
+#include <cstdint>
+#include <vector>
+#include "TimeSeries.h"
+#include "TimeSeriesSoA.h"
+
+// Modello di generate_timeseries.py (campioni orari): trend lineare +
+// stagionalità sinusoidale + rumore gaussiano
+//   x(t) = base + trendPerPoint * t + amplitude * sin(2 pi t / period) + N(0, noiseStd)
+struct SyntheticSpec
+{
+    size_t numSeries = 0;
+    size_t seriesLength = 0;
+    size_t queryLength = 0;
+    uint64_t seed = 42;
+
+    double base = 100.0;
+    double trendPerPoint = 2.0 / 96.0; // 2 ogni 4 giorni
+    double amplitude = 20.0;
+    double period = 168.0;             // 7 giorni
+    double noiseStd = 5.0;
+
+    // Serie (distinte) in cui copiare la query, a posizioni casuali
+    size_t plantedQueries = 0;
+};
+
+// Occorrenza esatta della query: la distanza della finestra è 0
+struct PlantedOccurrence
+{
+    size_t series;
+    size_t position;
+};
+
+// Generatore riproducibile: ogni serie ha il proprio flusso pseudocasuale
+// derivato da (seed, indice), quindi il risultato non dipende dal numero di
+// thread né dallo scheduling
+class SyntheticGenerator
+{
+public:
+    static TimeSeries generateQuery(const SyntheticSpec &spec);
+
+    // Dataset scritto direttamente nello storage, serie distribuite tra i thread;
+    // con spec.plantedQueries > 0 copia query nelle serie e registra le posizioni
+    static TimeSeriesSoA generate(const SyntheticSpec &spec,
+                                  StorageLayout layout,
+                                  const TimeSeries &query,
+                                  std::vector<PlantedOccurrence> *planted = nullptr);
+};
+
+#endif // SYNTHETICGENERATOR_H
@@ -3,6 +3,8 @@
 
 #include <vector>
 #include <iostream>
+#include "FlatStorage.h"
+#include "SeriesView.h"
 
 struct Sample
 {
@@ -16,70 +18,94 @@ struct Sample
 class TimeSeriesAoS
 {
 public:
+    explicit TimeSeriesAoS(StorageLayout layout = StorageLayout::RowMajor) : data(layout) {}
+
+    // Dataset costruito su uno storage esistente (es. vista su un file mappato)
+    explicit TimeSeriesAoS(FlatStorage<Sample> storage) : data(std::move(storage)) {}
+
     void addSeries(const std::vector<double> &values)
     {
-        std::vector<Sample> sampleSeries;
-        sampleSeries.reserve(values.size());
-        for (double val : values)
-        {
-            sampleSeries.emplace_back(val);
-        }
-        data.push_back(std::move(sampleSeries));
+        data.addSeries(values);
+    }
+
+    void reserve(size_t numSeries, size_t seriesLength)
+    {
+        data.reserve(numSeries, seriesLength);
     }
 
     size_t getNumSeries() const
     {
-        return data.size();
+        return data.getNumSeries();
     }
 
     size_t getSeriesLength() const
     {
-        if (data.empty())
+        if (data.getNumSeries() == 0)
             return 0;
-        return data[0].size();
+        return data.getSeriesLength(0);
     }
 
-    const std::vector<Sample> &getSeriesSamples(size_t index) const
+    size_t getSeriesLength(size_t seriesIndex) const
     {
-        return data[index];
+        return data.getSeriesLength(seriesIndex);
     }
 
-    const std::vector<double> getSeries(size_t index) const
+    StorageLayout getLayout() const
     {
-        const auto &samples = data[index];
-        std::vector<double> result;
-        result.reserve(samples.size());
-        for (const auto &sample : samples)
-        {
-            result.push_back(sample.value);
-        }
-        return result;
+        return data.getLayout();
+    }
+
+    // Puntatore grezzo al primo campione della serie, i successivi sono a getStride()
+    const Sample *getSeriesSamples(size_t index) const
+    {
+        return data.getSeriesData(index);
+    }
+
+    size_t getStride() const
+    {
+        return data.getStride();
+    }
+
+    // Vista senza copia sui campioni della serie
+    SeriesView<Sample> getSeries(size_t index) const
+    {
+        return SeriesView<Sample>(data.getSeriesData(index), data.getSeriesLength(index), data.getStride());
     }
 
     inline const Sample &getSample(size_t seriesIndex, size_t timeIndex) const
     {
-        return data[seriesIndex][timeIndex];
+        return data.at(seriesIndex, timeIndex);
     }
 
     inline double getValue(size_t seriesIndex, size_t timeIndex) const
     {
-        return data[seriesIndex][timeIndex].value;
+        return data.at(seriesIndex, timeIndex).value;
+    }
+
+    size_t sizeInBytes() const
+    {
+        return data.sizeInBytes();
+    }
+
+    const FlatStorage<Sample> &getStorage() const
+    {
+        return data;
     }
 
     void print() const
     {
-        for (const auto &series : data)
+        for (size_t i = 0; i < data.getNumSeries(); ++i)
         {
-            for (const auto &sample : series)
+            for (size_t t = 0; t < data.getSeriesLength(i); ++t)
             {
-                std::cout << sample.value << " ";
+                std::cout << data.at(i, t).value << " ";
             }
             std::cout << std::endl;
         }
     }
 
 private:
-    std::vector<std::vector<Sample>> data;
+    FlatStorage<Sample> data;
 };
 
-#endif // TIMESERIESAOS_H
\ No newline at end of file
+#endif // TIMESERIESAOS_H
@@ -3,58 +3,83 @@
 
 #include <vector>
 #include <iostream>
+#include "FlatStorage.h"
+#include "SeriesView.h"
 
 class TimeSeriesSoA
 {
 public:
+    explicit TimeSeriesSoA(StorageLayout layout = StorageLayout::ColumnMajor) : timePoints(layout) {}
+
+    // Dataset costruito su uno storage esistente (es. vista su un file mappato)
+    explicit TimeSeriesSoA(FlatStorage<double> storage) : timePoints(std::move(storage)) {}
+
     void addSeries(const std::vector<double> &values)
     {
         if (values.empty())
             return;
 
-        if (timePoints.empty())
-        {
-            timePoints.resize(values.size());
-        }
-
-        if (values.size() > timePoints.size())
-        {
-            timePoints.resize(values.size());
-        }
-
-        for (size_t t = 0; t < values.size(); ++t)
-        {
-            timePoints[t].push_back(values[t]);
-        }
+        timePoints.addSeries(values);
+    }
 
-        seriesLengths.push_back(values.size());
-        numSeries++;
+    void reserve(size_t numSeries, size_t seriesLength)
+    {
+        timePoints.reserve(numSeries, seriesLength);
     }
 
     size_t getNumSeries() const
     {
-        return numSeries;
+        return timePoints.getNumSeries();
     }
 
     size_t getMaxTimePoints() const
     {
-        return timePoints.size();
+        return timePoints.getMaxLength();
     }
 
     size_t getSeriesLength(size_t seriesIndex) const
     {
-        return seriesLengths[seriesIndex];
+        return timePoints.getSeriesLength(seriesIndex);
+    }
+
+    StorageLayout getLayout() const
+    {
+        return timePoints.getLayout();
+    }
+
+    // Puntatore grezzo al primo valore della serie, i successivi sono a getStride()
+    const double *getSeriesData(size_t seriesIndex) const
+    {
+        return timePoints.getSeriesData(seriesIndex);
+    }
+
+    size_t getStride() const
+    {
+        return timePoints.getStride();
+    }
+
+    SeriesView<double> getSeries(size_t seriesIndex) const
+    {
+        return SeriesView<double>(getSeriesData(seriesIndex), getSeriesLength(seriesIndex), getStride());
     }
 
     inline double getValue(size_t seriesIndex, size_t timeIndex) const
     {
-        return timePoints[timeIndex][seriesIndex];
+        return timePoints.at(seriesIndex, timeIndex);
+    }
+
+    size_t sizeInBytes() const
+    {
+        return timePoints.sizeInBytes();
+    }
+
+    const FlatStorage<double> &getStorage() const
+    {
+        return timePoints;
     }
 
 private:
-    std::vector<std::vector<double>> timePoints;
-    std::vector<size_t> seriesLengths;           
-    size_t numSeries = 0;
+    FlatStorage<double> timePoints;
 };
 
-#endif // TIMESERIESSOA_H
\ No newline at end of file
+#endif // TIMESERIESSOA_H
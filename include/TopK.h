@@ -0,0 +1,101 @@
+#ifndef TOPK_H
+#define TOPK_H
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+// Una finestra della ricerca: serie, posizione di inizio e SAD
+struct Match
+{
+    size_t seriesIndex;
+    size_t offset;
+    double sad;
+};
+
+// Ordine totale dei match: SAD crescente, a parità indice di serie e offset più bassi
+inline bool betterMatch(const Match &a, const Match &b)
+{
+    if (a.sad != b.sad)
+        return a.sad < b.sad;
+    if (a.seriesIndex != b.seriesIndex)
+        return a.seriesIndex < b.seriesIndex;
+    return a.offset < b.offset;
+}
+
+// Heap limitato ai K migliori match: in cima c'è il K-esimo, che è anche la
+// soglia oltre cui una finestra non può più entrare nel risultato
+class TopKHeap
+{
+public:
+    explicit TopKHeap(size_t k = 0) : k(k)
+    {
+        matches.reserve(k);
+    }
+
+    size_t capacity() const
+    {
+        return k;
+    }
+
+    size_t size() const
+    {
+        return matches.size();
+    }
+
+    bool full() const
+    {
+        return matches.size() == k;
+    }
+
+    // SAD del K-esimo match, max() finché l'heap non è pieno
+    double threshold() const
+    {
+        if (k == 0)
+            return std::numeric_limits<double>::lowest();
+        return full() ? matches.front().sad : std::numeric_limits<double>::max();
+    }
+
+    void push(const Match &match)
+    {
+        if (matches.size() < k)
+        {
+            matches.push_back(match);
+            std::push_heap(matches.begin(), matches.end(), betterMatch);
+        }
+        else if (k > 0 && betterMatch(match, matches.front()))
+        {
+            std::pop_heap(matches.begin(), matches.end(), betterMatch);
+            matches.back() = match;
+            std::push_heap(matches.begin(), matches.end(), betterMatch);
+        }
+    }
+
+    void merge(const TopKHeap &other)
+    {
+        for (const Match &match : other.matches)
+        {
+            push(match);
+        }
+    }
+
+    // Match ordinati dal migliore
+    std::vector<Match> sorted() const
+    {
+        std::vector<Match> result(matches);
+        std::sort(result.begin(), result.end(), betterMatch);
+        return result;
+    }
+
+    void clear()
+    {
+        matches.clear();
+    }
+
+private:
+    size_t k;
+    std::vector<Match> matches;
+};
+
+#endif // TOPK_H
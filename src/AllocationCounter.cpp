@@ -0,0 +1,72 @@
+#include "../include/AllocationCounter.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<bool> countingEnabled{false};
+    std::atomic<size_t> allocationCount{0};
+
+    inline void recordAllocation()
+    {
+        if (countingEnabled.load(std::memory_order_relaxed))
+        {
+            allocationCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void AllocationCounter::setEnabled(bool enabled)
+{
+    countingEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool AllocationCounter::isEnabled()
+{
+    return countingEnabled.load(std::memory_order_relaxed);
+}
+
+size_t AllocationCounter::count()
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+// new[] e le varianti nothrow di libstdc++ delegano a queste due funzioni
+void *operator new(std::size_t size)
+{
+    recordAllocation();
+    if (void *ptr = std::malloc(size > 0 ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    recordAllocation();
+    std::size_t align = static_cast<std::size_t>(alignment);
+    std::size_t rounded = (size + align - 1) / align * align;
+    if (void *ptr = std::aligned_alloc(align, rounded > 0 ? rounded : align))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept
+{
+    std::free(ptr);
+}
@@ -1,15 +1,38 @@
 #include "../include/Benchmark.h"
+#include "../include/BenchmarkConfig.h"
+#include "../include/SyntheticGenerator.h"
 #include <iostream>
 #include <iomanip>
 #include <cmath>
 #include "Benchmark.h"
 #include <filesystem>
 #include <DataLoading.h>
+#include "../include/AllocationCounter.h"
+#include "../include/DatasetBuilder.h"
+#include "../include/StreamingSearch.h"
+#include "../include/SadKernels.h"
+#include "../include/FftDistance.h"
+#include "../include/MatrixProfile.h"
+#include "../include/NumaPlacement.h"
+#include "../include/MemoryUsage.h"
+#include "../include/DatasetIndex.h"
+#include "../include/PerfCounters.h"
+#include "../include/Roofline.h"
 #include <numeric>
 #include <algorithm>
+#include <random>
 
 namespace
 {
+    // Query su cui si misura la recall della ricerca approssimata (altrettante
+    // servono per la calibrazione)
+    constexpr size_t APPROXIMATE_RECALL_QUERIES = 8;
+
+    // Scarto relativo ammesso rispetto ai sadValues di riferimento: i kernel
+    // diretti sono identici bit a bit, il motore FFT no
+    constexpr double SAD_MATCH_TOLERANCE = 1e-9;
+    constexpr double FFT_MATCH_TOLERANCE = 1e-6;
+
     double calculate_mean(const std::vector<double> &values)
     {
         if (values.empty())
@@ -30,274 +53,346 @@ namespace
         return std::sqrt(variance);
     }
 
-    void fill_statistics(BenchmarkResult &result)
+    // Quantile 0.975 della t di Student con df gradi di libertà (oltre 30: normale)
+    double student_t_975(size_t df)
     {
-        if (result.execution_times_ms.empty())
-            return;
-
-        result.mean_execution_time_ms = calculate_mean(result.execution_times_ms);
-        result.std_deviation_ms = calculate_std_deviation(result.execution_times_ms, result.mean_execution_time_ms);
-        result.min_execution_time_ms = *std::min_element(result.execution_times_ms.begin(), result.execution_times_ms.end());
-        result.max_execution_time_ms = *std::max_element(result.execution_times_ms.begin(), result.execution_times_ms.end());
-        result.num_runs = result.execution_times_ms.size();
+        static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                       2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                       2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+        if (df == 0)
+            return std::numeric_limits<double>::infinity();
+        return df <= 30 ? table[df - 1] : 1.96;
     }
-}
 
-BenchmarkResult Benchmark::benchmarkSequentialSoA(const TimeSeriesSoA &dataset,
-                                                  const TimeSeries &query,
-                                                  const std::string &test_name,
-                                                  int num_runs)
-{
-    std::vector<double> execution_times;
-    std::vector<double> sadValues;
-    size_t bestIndex = 0;
-
-    std::cout << "  Running " << num_runs << " iterations for Sequential SoA..." << std::flush;
-
-    for (int run = 0; run < num_runs; ++run)
+    // Semiampiezza dell'intervallo di confidenza al 95% della media
+    double ci_half_width(const std::vector<double> &values)
     {
-        auto start = std::chrono::high_resolution_clock::now();
-
-        auto [currentSadValues, currentBestIndex] = SearchEngine::searchSequentialSoA(dataset, query);
+        if (values.size() < 2)
+            return 0.0;
+        double mean = calculate_mean(values);
+        return student_t_975(values.size() - 1) * calculate_std_deviation(values, mean) / std::sqrt(values.size());
+    }
 
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    double calculate_median(std::vector<double> values)
+    {
+        if (values.empty())
+            return 0.0;
+        size_t middle = values.size() / 2;
+        std::nth_element(values.begin(), values.begin() + middle, values.end());
+        double upper = values[middle];
+        if (values.size() % 2 == 1)
+            return upper;
+        return (*std::max_element(values.begin(), values.begin() + middle) + upper) / 2.0;
+    }
 
-        execution_times.push_back(duration.count() / 1000.0);
+    // Sposta in rejected i tempi oltre threshold MAD dalla mediana (MAD scalata
+    // a sigma per dati normali); threshold <= 0 disabilita lo scarto
+    void reject_outliers(std::vector<double> &times, std::vector<double> &rejected, double threshold)
+    {
+        if (threshold <= 0.0 || times.size() < 3)
+            return;
 
-        if (run == 0)
+        double median = calculate_median(times);
+        std::vector<double> deviations;
+        deviations.reserve(times.size());
+        for (double time : times)
         {
-            sadValues = currentSadValues;
-            bestIndex = currentBestIndex;
+            deviations.push_back(std::abs(time - median));
         }
+        double mad = 1.4826 * calculate_median(deviations);
+        if (mad <= 0.0)
+            return;
 
-        std::cout << "." << std::flush;
+        std::vector<double> kept;
+        for (double time : times)
+        {
+            (std::abs(time - median) > threshold * mad ? rejected : kept).push_back(time);
+        }
+        times = std::move(kept);
     }
-    std::cout << " Done" << std::endl;
-
-    BenchmarkResult result;
-    result.algorithm_name = "Sequential_SoA_" + test_name;
-    result.num_series = dataset.getNumSeries();
-    result.series_length = dataset.getNumSeries() > 0 ? dataset.getSeriesLength(0) : 0;
-    result.query_length = query.getSize();
-    result.execution_times_ms = execution_times;
-    result.best_match_index = bestIndex;
-    result.best_sad_value = sadValues[bestIndex];
-
-    fill_statistics(result);
-
-    return result;
-}
-
-BenchmarkResult Benchmark::benchmarkSoA_parallelOuter(const TimeSeriesSoA &dataset,
-                                                      const TimeSeries &query,
-                                                      const std::string &test_name,
-                                                      int num_runs)
-{
-    std::vector<double> execution_times;
-    std::vector<double> sadValues;
-    size_t bestIndex = 0;
-
-    std::cout << "  Running " << num_runs << " iterations for Parallel SoA Outer..." << std::flush;
 
-    for (int run = 0; run < num_runs; ++run)
+    // Confronto con i sadValues di riferimento secondo check. Con
+    // shareGlobalBest le serie che non possono battere il migliore hanno solo
+    // un limite superiore, quindi si confronta il solo minimo; con il motore
+    // FFT si tollera il suo errore di arrotondamento. max_difference riceve
+    // lo scarto assoluto massimo
+    bool sad_values_match(const std::vector<double> &reference, const std::vector<double> &values,
+                          ResultCheck check, const SearchOptions &options, double &max_difference)
     {
-        auto start = std::chrono::high_resolution_clock::now();
-
-        auto [currentSadValues, currentBestIndex] = SearchEngine::searchParallelSoAOuter(dataset, query);
-
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-
-        execution_times.push_back(duration.count() / 1000.0);
+        max_difference = 0.0;
+        if (reference.empty() || values.empty() || (check == ResultCheck::AllValues && reference.size() != values.size()))
+        {
+            max_difference = std::numeric_limits<double>::infinity();
+            return reference.size() == values.size();
+        }
 
-        if (run == 0)
+        double tolerance = options.engine != DistanceEngine::Direct && FftDistance::supports(options.metric)
+                               ? FFT_MATCH_TOLERANCE
+                               : SAD_MATCH_TOLERANCE;
+        bool match = true;
+        auto compare = [&](double expected, double actual)
         {
-            sadValues = currentSadValues;
-            bestIndex = currentBestIndex;
+            double difference = std::abs(expected - actual);
+            max_difference = std::max(max_difference, difference);
+            match = match && difference <= tolerance * std::max(1.0, std::abs(expected));
+        };
+
+        auto reference_best = std::min_element(reference.begin(), reference.end());
+        auto best = std::min_element(values.begin(), values.end());
+        if (check == ResultCheck::BestIndex)
+        {
+            // Distanze stimate: conta solo la serie scelta
+            max_difference = std::abs(*reference_best - *best);
+            return reference_best - reference.begin() == best - values.begin();
         }
 
-        std::cout << "." << std::flush;
+        if (check == ResultCheck::BestMatch || options.shareGlobalBest)
+        {
+            compare(*reference_best, *best);
+        }
+        else
+        {
+            for (size_t i = 0; i < reference.size(); ++i)
+            {
+                compare(reference[i], values[i]);
+            }
+        }
+        return match;
     }
-    std::cout << " Done" << std::endl;
-
-    BenchmarkResult result;
-    result.algorithm_name = "Parallel_SoA_Outer_" + test_name;
-    result.num_series = dataset.getNumSeries();
-    result.series_length = dataset.getNumSeries() > 0 ? dataset.getSeriesLength(0) : 0;
-    result.query_length = query.getSize();
-    result.execution_times_ms = execution_times;
-    result.best_match_index = bestIndex;
-    result.best_sad_value = sadValues[bestIndex];
-
-    fill_statistics(result);
-
-    return result;
-}
 
-BenchmarkResult Benchmark::benchmarkSoA_parallelInner(const TimeSeriesSoA &dataset,
-                                                      const TimeSeries &query,
-                                                      const std::string &test_name,
-                                                      int num_runs)
-{
-    std::vector<double> execution_times;
-    std::vector<double> sadValues;
-    size_t bestIndex = 0;
-
-    std::cout << "  Running " << num_runs << " iterations for Parallel SoA Inner..." << std::flush;
-
-    for (int run = 0; run < num_runs; ++run)
+    // Query aggiuntive per il batch: la query del test più finestre del dataset
+    // (serie e offset pseudo-casuali con seed fisso, quindi ripetibili)
+    std::vector<TimeSeries> make_batch_queries(const TimeSeriesSoA &dataset, const TimeSeries &query, size_t count)
     {
-        auto start = std::chrono::high_resolution_clock::now();
-
-        auto [currentSadValues, currentBestIndex] = SearchEngine::searchParallelSoAInner(dataset, query);
-
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-
-        execution_times.push_back(duration.count() / 1000.0);
+        std::vector<TimeSeries> queries;
+        queries.reserve(count);
+        queries.push_back(query);
 
-        if (run == 0)
+        std::mt19937 rng(42);
+        size_t length = query.getSize();
+        while (queries.size() < count)
         {
-            sadValues = currentSadValues;
-            bestIndex = currentBestIndex;
+            size_t series = rng() % dataset.getNumSeries();
+            size_t seriesLength = dataset.getSeriesLength(series);
+            if (seriesLength < length)
+            {
+                queries.push_back(query);
+                continue;
+            }
+
+            size_t offset = rng() % (seriesLength - length + 1);
+            std::vector<double> values(length);
+            for (size_t k = 0; k < length; ++k)
+            {
+                values[k] = dataset.getValue(series, offset + k);
+            }
+            queries.emplace_back(values);
         }
 
-        std::cout << "." << std::flush;
+        return queries;
     }
-    std::cout << " Done" << std::endl;
-
-    BenchmarkResult result;
-    result.algorithm_name = "Parallel_SoA_Inner_" + test_name;
-    result.num_series = dataset.getNumSeries();
-    result.series_length = dataset.getNumSeries() > 0 ? dataset.getSeriesLength(0) : 0;
-    result.query_length = query.getSize();
-    result.execution_times_ms = execution_times;
-    result.best_match_index = bestIndex;
-    result.best_sad_value = sadValues[bestIndex];
 
-    fill_statistics(result);
-
-    return result;
-}
-
-BenchmarkResult Benchmark::benchmarkSequentialAoS(const TimeSeriesAoS &dataset,
-                                                  const TimeSeries &query,
-                                                  const std::string &test_name,
-                                                  int num_runs)
-{
-    std::vector<double> execution_times;
-    std::vector<double> sadValues;
-    size_t bestIndex = 0;
-
-    std::cout << "  Running " << num_runs << " iterations for Sequential AoS..." << std::flush;
+    // Campioni di ogni serie da riprodurre in streaming
+    std::vector<std::vector<double>> make_stream_feeds(const TimeSeriesSoA &dataset)
+    {
+        std::vector<std::vector<double>> feeds(dataset.getNumSeries());
+        for (size_t i = 0; i < feeds.size(); ++i)
+        {
+            feeds[i].resize(dataset.getSeriesLength(i));
+            for (size_t t = 0; t < feeds[i].size(); ++t)
+            {
+                feeds[i][t] = dataset.getValue(i, t);
+            }
+        }
+        return feeds;
+    }
 
-    for (int run = 0; run < num_runs; ++run)
+    void fill_statistics(BenchmarkResult &result)
     {
-        auto start = std::chrono::high_resolution_clock::now();
+        if (result.execution_times_ms.empty())
+            return;
 
-        auto [currentSadValues, currentBestIndex] = SearchEngine::searchSequentialAoS(dataset, query);
+        result.mean_execution_time_ms = calculate_mean(result.execution_times_ms);
+        result.std_deviation_ms = calculate_std_deviation(result.execution_times_ms, result.mean_execution_time_ms);
+        result.min_execution_time_ms = *std::min_element(result.execution_times_ms.begin(), result.execution_times_ms.end());
+        result.max_execution_time_ms = *std::max_element(result.execution_times_ms.begin(), result.execution_times_ms.end());
+        result.num_runs = result.execution_times_ms.size();
+    }
 
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    // Kernel diretto contro FFT (Inner SoA) per query di lunghezza crescente,
+    // prese dall'inizio della prima serie: mostra il punto di crossover reale
+    // accanto a quello stimato dal modello di costo di FftDistance
+    nlohmann::json fft_crossover(const TimeSeriesSoA &dataset, const std::string &test_name,
+                                 const HarnessOptions &harness, const SearchOptions &options)
+    {
+        SearchOptions sweep_options = options;
+        if (!FftDistance::supports(sweep_options.metric))
+        {
+            sweep_options.metric = DistanceMetric::SquaredEuclidean;
+        }
 
-        execution_times.push_back(duration.count() / 1000.0);
+        nlohmann::json sweep = {
+            {"metric", distanceMetricName(sweep_options.metric)},
+            {"points", nlohmann::json::array()}};
 
-        if (run == 0)
+        size_t series_length = dataset.getNumSeries() > 0 ? dataset.getSeriesLength(0) : 0;
+        for (size_t length = 16; length <= series_length / 2; length *= 2)
         {
-            sadValues = currentSadValues;
-            bestIndex = currentBestIndex;
+            std::vector<double> values(length);
+            for (size_t k = 0; k < length; ++k)
+            {
+                values[k] = dataset.getValue(0, k);
+            }
+            TimeSeries query(values);
+
+            nlohmann::json point = {{"query_length", length}};
+            for (DistanceEngine engine : {DistanceEngine::Direct, DistanceEngine::Fft, DistanceEngine::Auto})
+            {
+                sweep_options.engine = engine;
+                BenchmarkResult engine_result = Benchmark::benchmarkStrategy(*BenchmarkRegistry::find("soa", "parallel_inner"), {&dataset, nullptr},
+                                                                             query, test_name, harness, sweep_options);
+                point[distanceEngineName(engine) + "_mean_execution_time_ms"] = std::round(engine_result.mean_execution_time_ms * 100.0) / 100.0;
+
+                if (engine == DistanceEngine::Auto)
+                {
+                    const SearchStats &stats = engine_result.search_stats;
+                    point["auto_fft_fraction"] = stats.totalTerms > 0
+                                                     ? static_cast<double>(stats.windowsFft * length) / stats.totalTerms
+                                                     : 0.0;
+                }
+            }
+
+            FftDistance model(query.getData().data(), length, sweep_options.metric);
+            point["predicted_crossover_series_length"] = model.crossoverLength();
+            point["fft_faster"] = point["fft_mean_execution_time_ms"].get<double>() < point["direct_mean_execution_time_ms"].get<double>();
+            sweep["points"].push_back(point);
         }
 
-        std::cout << "." << std::flush;
+        return sweep;
     }
-    std::cout << " Done" << std::endl;
 
-    BenchmarkResult result;
-    result.algorithm_name = "Sequential_AoS_" + test_name;
-    result.num_series = dataset.getNumSeries();
-    result.series_length = dataset.getNumSeries() > 0 ? dataset.getSeries(0).size() : 0;
-    result.query_length = query.getSize();
-    result.execution_times_ms = execution_times;
-    result.best_match_index = bestIndex;
-    result.best_sad_value = sadValues[bestIndex];
-
-    fill_statistics(result);
-
-    return result;
-}
-
-BenchmarkResult Benchmark::benchmarkAoS_parallelOuter(const TimeSeriesAoS &dataset,
-                                                      const TimeSeries &query,
-                                                      const std::string &test_name,
-                                                      int num_runs)
-{
-    std::vector<double> execution_times;
-    std::vector<double> sadValues;
-    size_t bestIndex = 0;
-
-    std::cout << "  Running " << num_runs << " iterations for Parallel AoS Outer..." << std::flush;
-
-    for (int run = 0; run < num_runs; ++run)
+    // Matrix profile (self-join + join tra serie) con finestre lunghe quanto
+    // la query: tempo, throughput in coppie di finestre e motif/discord principali
+    nlohmann::json matrix_profile(const TimeSeriesSoA &dataset, size_t window_length, int num_runs)
     {
-        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<double> execution_times;
+        MatrixProfileResult profile;
 
-        auto [currentSadValues, currentBestIndex] = SearchEngine::searchParallelAoSOuter(dataset, query);
+        std::cout << "  Running " << num_runs << " iterations for Matrix Profile SoA..." << std::flush;
 
-        auto end = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+        for (int run = 0; run < num_runs; ++run)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            profile = MatrixProfile::computeSoA(dataset, window_length);
+            auto end = std::chrono::high_resolution_clock::now();
+            execution_times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
 
-        execution_times.push_back(duration.count() / 1000.0);
+        std::cout << " Done!" << std::endl;
+
+        double mean_ms = calculate_mean(execution_times);
+        double windows = static_cast<double>(profile.numWindows());
+        nlohmann::json result = {
+            {"window_length", window_length},
+            {"exclusion_zone", MatrixProfile::exclusionZone(window_length)},
+            {"num_windows", profile.numWindows()},
+            {"mean_execution_time_ms", std::round(mean_ms * 100.0) / 100.0},
+            {"std_deviation_ms", std::round(calculate_std_deviation(execution_times, mean_ms) * 100.0) / 100.0},
+            {"pairs_per_second", mean_ms > 0.0 ? std::round(windows * windows / 2.0 * 1000.0 / mean_ms) : 0.0},
+            {"all_execution_times", execution_times}};
+
+        std::vector<Motif> motifs = MatrixProfile::motifs(profile, 1);
+        if (!motifs.empty())
+        {
+            result["top_motif"] = {
+                {"series_index", motifs[0].window.seriesIndex},
+                {"offset", motifs[0].window.offset},
+                {"neighbor_series_index", motifs[0].neighbor.seriesIndex},
+                {"neighbor_offset", motifs[0].neighbor.offset},
+                {"distance", motifs[0].window.sad}};
+        }
 
-        if (run == 0)
+        std::vector<Match> discords = MatrixProfile::discords(profile, 1);
+        if (!discords.empty())
         {
-            sadValues = currentSadValues;
-            bestIndex = currentBestIndex;
+            result["top_discord"] = {
+                {"series_index", discords[0].seriesIndex},
+                {"offset", discords[0].offset},
+                {"distance", discords[0].sad}};
         }
 
-        std::cout << "." << std::flush;
+        return result;
     }
-    std::cout << " Done" << std::endl;
-
-    BenchmarkResult result;
-    result.algorithm_name = "Parallel_AoS_Outer_" + test_name;
-    result.num_series = dataset.getNumSeries();
-    result.series_length = dataset.getNumSeries() > 0 ? dataset.getSeries(0).size() : 0;
-    result.query_length = query.getSize();
-    result.execution_times_ms = execution_times;
-    result.best_match_index = bestIndex;
-    result.best_sad_value = sadValues[bestIndex];
-
-    fill_statistics(result);
-
-    return result;
 }
 
-BenchmarkResult Benchmark::benchmarkAoS_parallelInner(const TimeSeriesAoS &dataset,
-                                                      const TimeSeries &query,
-                                                      const std::string &test_name,
-                                                      int num_runs)
+BenchmarkResult Benchmark::benchmarkStrategy(const BenchmarkStrategy &strategy,
+                                             const BenchmarkDatasets &datasets,
+                                             const TimeSeries &query,
+                                             const std::string &test_name,
+                                             const HarnessOptions &harness,
+                                             const SearchOptions &options,
+                                             const std::vector<double> *reference)
 {
     std::vector<double> execution_times;
     std::vector<double> sadValues;
     size_t bestIndex = 0;
+    size_t allocations = 0;
+    SearchStats stats;
+    PerfCounters perf;
+    LoadBalance load_balance;
+    SearchOptions run_options = options;
+    run_options.stats = &stats;
+    run_options.loadBalance = &load_balance;
+
+    size_t min_runs = static_cast<size_t>(std::max(harness.min_runs, 1));
+    size_t max_runs = std::max(static_cast<size_t>(std::max(harness.max_runs, 0)), min_runs);
+
+    // Ripetizioni sufficienti: minimo raggiunto e intervallo di confidenza
+    // (sui tempi senza outlier) entro il target
+    auto converged = [&]()
+    {
+        if (execution_times.size() < min_runs)
+            return false;
+        if (harness.ci_target <= 0.0 || execution_times.size() >= max_runs)
+            return true;
+
+        std::vector<double> kept = execution_times;
+        std::vector<double> rejected;
+        reject_outliers(kept, rejected, harness.outlier_mad);
+        return kept.size() >= 2 && ci_half_width(kept) <= harness.ci_target * calculate_mean(kept);
+    };
 
-    std::cout << "  Running " << num_runs << " iterations for Parallel AoS Inner..." << std::flush;
+    std::cout << "  Running " << min_runs;
+    if (max_runs > min_runs)
+    {
+        std::cout << "-" << max_runs;
+    }
+    std::cout << " iterations for " << strategy.label << "..." << std::flush;
 
-    for (int run = 0; run < num_runs; ++run)
+    // Warmup senza statistiche: cache, pagine del dataset e team OpenMP
+    for (int run = 0; run < harness.warmup_runs; ++run)
     {
+        strategy.search(datasets, query, options);
+    }
+
+    while (!converged())
+    {
+        size_t allocations_before = AllocationCounter::count();
+        perf.start();
         auto start = std::chrono::high_resolution_clock::now();
 
-        auto [currentSadValues, currentBestIndex] = SearchEngine::searchParallelAoSInner(dataset, query);
+        auto [currentSadValues, currentBestIndex] = strategy.search(datasets, query, run_options);
 
         auto end = std::chrono::high_resolution_clock::now();
+        perf.stop();
+        allocations += AllocationCounter::count() - allocations_before;
         auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
 
         execution_times.push_back(duration.count() / 1000.0);
 
-        if (run == 0)
+        if (execution_times.size() == 1)
         {
-            sadValues = currentSadValues;
+            sadValues = std::move(currentSadValues);
             bestIndex = currentBestIndex;
         }
 
@@ -305,14 +400,35 @@ BenchmarkResult Benchmark::benchmarkAoS_parallelInner(const TimeSeriesAoS &datas
     }
     std::cout << " Done" << std::endl;
 
+    size_t measured = execution_times.size();
+    bool soa = strategy.layout == "soa";
+
     BenchmarkResult result;
-    result.algorithm_name = "Parallel_AoS_Inner_" + test_name;
-    result.num_series = dataset.getNumSeries();
-    result.series_length = dataset.getNumSeries() > 0 ? dataset.getSeries(0).size() : 0;
+    std::string label = strategy.label;
+    std::replace(label.begin(), label.end(), ' ', '_');
+    result.algorithm_name = label + "_" + test_name;
+    result.num_series = soa ? datasets.soa->getNumSeries() : datasets.aos->getNumSeries();
+    result.series_length = result.num_series > 0 ? (soa ? datasets.soa->getSeriesLength(0) : datasets.aos->getSeriesLength(0)) : 0;
     result.query_length = query.getSize();
+    reject_outliers(execution_times, result.rejected_times_ms, harness.outlier_mad);
     result.execution_times_ms = execution_times;
+    result.ci_half_width_ms = ci_half_width(execution_times);
+    result.warmup_runs = std::max(harness.warmup_runs, 0);
     result.best_match_index = bestIndex;
-    result.best_sad_value = sadValues[bestIndex];
+    result.best_sad_value = sadValues.empty() ? std::numeric_limits<double>::max() : sadValues[bestIndex];
+    result.allocations_per_query = static_cast<double>(allocations) / measured;
+    result.pruned_fraction = stats.prunedFraction();
+    result.search_stats = stats;
+    result.thread_busy_ms = load_balance.busyMs;
+    result.load_imbalance = load_balance.imbalance();
+    result.sad_values = std::move(sadValues);
+
+    if (reference != nullptr)
+    {
+        result.results_match_reference = sad_values_match(*reference, result.sad_values, strategy.check, options, result.max_sad_difference);
+    }
+
+    result.perf = perf.total();
 
     fill_statistics(result);
 
@@ -374,26 +490,76 @@ nlohmann::json Benchmark::run_test(const TestConfiguration &config)
 {
     nlohmann::json result;
 
-    if (!generateDataset(config))
-    {
-        result["error"] = "Failed to generate dataset";
-        return result;
-    }
-
+    // File esistenti indicati nella configurazione, dataset generato in
+    // memoria oppure CSV generato (o già generato) dallo script Python
     std::string test_name = std::to_string(config.num_series) + "_" +
                             std::to_string(config.series_length) + "_" +
                             std::to_string(config.query_length);
+    std::string dataset_path;
+    std::string query_path;
+    bool generated = config.dataset_path.empty() && config.generator == "native";
+    if (!config.dataset_path.empty())
+    {
+        dataset_path = config.dataset_path;
+        query_path = config.query_path;
+        test_name = std::filesystem::path(dataset_path).stem().string();
+        if (!std::filesystem::exists(dataset_path) || !std::filesystem::exists(query_path))
+        {
+            std::cerr << "Dataset or query not found: " << dataset_path << ", " << query_path << std::endl;
+            result["error"] = "Dataset or query file not found";
+            return result;
+        }
+    }
+    else if (!generated)
+    {
+        if (!generateDataset(config))
+        {
+            result["error"] = "Failed to generate dataset";
+            return result;
+        }
+
+        dataset_path = "src/utils/data/timeseries/timeseries_" + test_name + ".csv";
+        query_path = "src/utils/data/query/query_" + test_name + ".csv";
+    }
 
-    std::string dataset_path = "src/utils/data/timeseries/timeseries_" + test_name + ".csv";
-    std::string query_path = "src/utils/data/query/query_" + test_name + ".csv";
+    TimeSeriesSoA datasetSoa(config.soa_layout);
+    TimeSeriesAoS datasetAos(config.aos_layout);
+    DatasetBuildReport build_report;
+    TimeSeries query(std::vector<double>{});
+    std::vector<PlantedOccurrence> planted;
+    if (generated)
+    {
+        SyntheticSpec spec;
+        spec.numSeries = config.num_series;
+        spec.seriesLength = config.series_length;
+        spec.queryLength = config.query_length;
+        spec.seed = static_cast<uint64_t>(config.seed);
+        spec.plantedQueries = config.planted_queries;
 
-    std::vector<TimeSeries> timeSeriesList = loadTimeSeriesAoS(dataset_path);
-    TimeSeriesSoA datasetSoa = loadTimeSeriesSoA(dataset_path);
-    TimeSeries query = loadQueryFromCSV(query_path);
+        std::cout << "Generating dataset: " << config.num_series << " series × "
+                  << config.series_length << " points, query length "
+                  << config.query_length << " (seed " << config.seed << ")" << std::endl;
 
-    TimeSeriesAoS datasetAos;
-    for (const auto& ts : timeSeriesList) {
-        datasetAos.addSeries(ts.getData());
+        auto start = std::chrono::high_resolution_clock::now();
+        query = SyntheticGenerator::generateQuery(spec);
+        datasetSoa = SyntheticGenerator::generate(spec, config.soa_layout, query, &planted);
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        build_report.phases.push_back({"generate", elapsed, MemoryUsage::currentRssBytes(), MemoryUsage::peakRssBytes()});
+
+        start = std::chrono::high_resolution_clock::now();
+        datasetAos = DatasetBuilder::toAoS(datasetSoa, config.aos_layout);
+        elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        build_report.phases.push_back({"relayout_aos", elapsed, MemoryUsage::currentRssBytes(), MemoryUsage::peakRssBytes()});
+
+        build_report.soa_source = "generated";
+        build_report.aos_source = "relayout";
+    }
+    else
+    {
+        // Un solo caricamento per entrambi i layout (cache binaria o CSV + trasposizione)
+        DatasetBuilder::build(dataset_path, config.soa_layout, config.aos_layout, config.binary_cache,
+                              datasetSoa, datasetAos, &build_report);
+        query = loadQueryFromCSV(query_path);
     }
 
     if (datasetAos.getNumSeries() == 0 || query.getSize() == 0)
@@ -402,14 +568,146 @@ nlohmann::json Benchmark::run_test(const TestConfiguration &config)
         return result;
     }
 
+    // Affinità dei thread prima del first touch, così ogni fetta del dataset
+    // finisce sul nodo del thread che la scandirà
+    ThreadAffinity affinity{config.omp_places, config.proc_bind};
+    bool threads_bound = NumaPlacement::bindThreads(affinity);
+    if (!config.proc_bind.empty() && !threads_bound)
+    {
+        std::cerr << "Thread binding " << config.proc_bind << " not available, using runtime defaults" << std::endl;
+    }
+
+    NumaPolicy requested_policy = NumaPolicy::None;
+    if (!parseNumaPolicy(config.numa_policy, requested_policy))
+    {
+        std::cerr << "NUMA policy " << config.numa_policy << " not available, using none" << std::endl;
+    }
+
+    NumaPolicy applied_policy = NumaPolicy::None;
+    if (requested_policy != NumaPolicy::None)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        applied_policy = NumaPlacement::place(datasetSoa, requested_policy);
+        NumaPlacement::place(datasetAos, requested_policy);
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        build_report.phases.push_back({"numa_placement", elapsed, MemoryUsage::currentRssBytes(), MemoryUsage::peakRssBytes()});
+    }
+
+    // Copia compatta del dataset per la ricerca a precisione ridotta
+    ElementType element_type = ElementType::Float64;
+    if (!parseElementType(config.element_type, element_type))
+    {
+        std::cerr << "Element type " << config.element_type << " not available, using float64" << std::endl;
+    }
+
+    CompactDataset compact;
+    if (element_type != ElementType::Float64)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        compact = CompactDataset::build(datasetSoa, element_type);
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        build_report.phases.push_back({"compact_build", elapsed, MemoryUsage::currentRssBytes(), MemoryUsage::peakRssBytes()});
+    }
+
+    // Indice a blocchi salvato accanto al CSV: riusato finché è più recente
+    // del dataset e ne descrive le serie, altrimenti ricostruito e salvato
+    // (solo in memoria per i dataset generati, che non hanno un file)
+    DatasetIndex index;
+    std::string index_source;
+    if (config.index_block_length > 0)
+    {
+        std::string index_path = generated ? "" : DatasetIndex::indexPath(dataset_path, config.index_block_length);
+        std::error_code error;
+        bool fresh = !generated && std::filesystem::exists(index_path, error) &&
+                     std::filesystem::last_write_time(index_path, error) >= std::filesystem::last_write_time(dataset_path, error);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        if (fresh)
+        {
+            index = DatasetIndex::load(index_path);
+            index_source = "disk";
+        }
+        if (!index.matches(datasetSoa) || index.getBlockLength() != static_cast<size_t>(config.index_block_length))
+        {
+            index = DatasetIndex::build(datasetSoa, config.index_block_length);
+            if (!generated)
+                index.save(index_path);
+            index_source = "built";
+        }
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        build_report.phases.push_back({index_source == "disk" ? "index_load" : "index_build", elapsed,
+                                       MemoryUsage::currentRssBytes(), MemoryUsage::peakRssBytes()});
+
+        result["index"] = {
+            {"path", index_path},
+            {"source", index_source},
+            {"block_length", index.getBlockLength()},
+            {"index_bytes", index.sizeInBytes()},
+            {"time_ms", std::round(elapsed * 1000.0) / 1000.0}};
+    }
+
     // Inizializza la struttura del risultato
     result["test_name"] = test_name;
-    result["configuration"] = {
-        {"num_series", config.num_series},
-        {"series_length", config.series_length},
-        {"query_length", config.query_length},
-        {"num_runs", config.num_runs},
-        {"thread_counts", config.thread_counts}};
+    result["configuration"] = BenchmarkConfig::toJson(config);
+    result["configuration"]["dataset_path"] = dataset_path;
+    result["configuration"]["query_path"] = query_path;
+
+    // Forma effettiva del dataset caricato (con dataset_path non è nota prima)
+    result["configuration"]["num_series"] = datasetSoa.getNumSeries();
+    result["configuration"]["series_length"] = datasetSoa.getSeriesLength(0);
+    result["configuration"]["query_length"] = query.getSize();
+
+    // Policy effettiva: "none" anche se richiesta su una macchina con un solo nodo
+    result["placement"] = {
+        {"numa_nodes", NumaPlacement::numNodes()},
+        {"requested_policy", numaPolicyName(requested_policy)},
+        {"policy", numaPolicyName(applied_policy)},
+        {"omp_places", config.omp_places},
+        {"num_places", NumaPlacement::places(config.omp_places).size()},
+        {"proc_bind", threads_bound ? config.proc_bind : "runtime"}};
+
+    result["storage"] = {
+        {"soa_layout", storageLayoutName(datasetSoa.getLayout())},
+        {"aos_layout", storageLayoutName(datasetAos.getLayout())},
+        {"soa_bytes", datasetSoa.sizeInBytes()},
+        {"aos_bytes", datasetAos.sizeInBytes()}};
+
+    if (element_type != ElementType::Float64)
+    {
+        result["storage"]["compact_type"] = elementTypeName(element_type);
+        result["storage"]["compact_bytes"] = compact.sizeInBytes();
+    }
+
+    auto to_mb = [](size_t bytes)
+    {
+        return std::round(bytes / (1024.0 * 1024.0) * 100.0) / 100.0;
+    };
+
+    nlohmann::json build_phases = nlohmann::json::array();
+    double build_time_ms = 0.0;
+    for (const DatasetBuildPhase &phase : build_report.phases)
+    {
+        build_phases.push_back({
+            {"phase", phase.name},
+            {"time_ms", std::round(phase.time_ms * 1000.0) / 1000.0},
+            {"rss_mb", to_mb(phase.rss_bytes)},
+            {"peak_rss_mb", to_mb(phase.peak_rss_bytes)}});
+        build_time_ms += phase.time_ms;
+    }
+
+    result["load"] = {
+        {"soa_source", build_report.soa_source},
+        {"aos_source", build_report.aos_source},
+        {"build_time_ms", std::round(build_time_ms * 1000.0) / 1000.0},
+        {"dataset_mb", to_mb(datasetSoa.sizeInBytes())},
+        {"phases", build_phases}};
+
+    if (build_report.csv_mb_per_s > 0.0)
+    {
+        result["load"]["csv_mb_per_s"] = std::round(build_report.csv_mb_per_s * 100.0) / 100.0;
+        std::cout << "Parsed " << dataset_path << " at " << std::fixed << std::setprecision(1)
+                  << build_report.csv_mb_per_s << " MB/s" << std::defaultfloat << std::endl;
+    }
 
     result["thread_results"] = nlohmann::json::object();
 
@@ -418,139 +716,493 @@ nlohmann::json Benchmark::run_test(const TestConfiguration &config)
         return std::round(value * 100.0) / 100.0;
     };
 
+    AllocationCounter::setEnabled(config.track_allocations);
+
+    // Senza permessi (o in una VM senza PMU) i contatori restano disabilitati
+    // e il benchmark prosegue con i soli tempi
+    std::string perf_reason;
+    bool perf_enabled = PerfCounters::setEnabled(config.perf_counters, &perf_reason);
+    result["perf_counters"] = {
+        {"requested", config.perf_counters},
+        {"available", perf_enabled}};
+    if (config.perf_counters && !perf_enabled)
+    {
+        result["perf_counters"]["reason"] = perf_reason;
+        std::cerr << "Hardware counters not available: " << perf_reason << std::endl;
+    }
+
+    // Contatori grezzi e metriche derivate: IPC, banda sul dataset (ogni
+    // esecuzione legge dataset_bytes) e termini SAD valutati per ciclo
+    auto perf_metrics = [&](const BenchmarkResult &benchmark_result, size_t dataset_bytes)
+    {
+        const PerfSample &sample = benchmark_result.perf;
+        nlohmann::json metrics = nlohmann::json::object();
+        for (size_t e = 0; e < NUM_PERF_EVENTS; ++e)
+        {
+            if (sample.available[e])
+            {
+                metrics[perfEventName(static_cast<PerfEvent>(e))] = sample.values[e];
+            }
+        }
+
+        // I contatori coprono anche le esecuzioni scartate come outlier
+        double total_seconds = (std::accumulate(benchmark_result.execution_times_ms.begin(), benchmark_result.execution_times_ms.end(), 0.0) +
+                                std::accumulate(benchmark_result.rejected_times_ms.begin(), benchmark_result.rejected_times_ms.end(), 0.0)) /
+                               1000.0;
+        if (total_seconds > 0.0)
+        {
+            metrics["gb_per_s"] = round2(dataset_bytes * static_cast<double>(benchmark_result.measured_runs()) / total_seconds / 1e9);
+            if (sample.has(PerfEvent::LlcMisses))
+            {
+                metrics["llc_miss_gb_per_s"] = round2(sample.get(PerfEvent::LlcMisses) * 64.0 / total_seconds / 1e9);
+            }
+        }
+
+        if (sample.has(PerfEvent::Cycles) && sample.get(PerfEvent::Cycles) > 0)
+        {
+            double cycles = static_cast<double>(sample.get(PerfEvent::Cycles));
+            if (sample.has(PerfEvent::Instructions))
+            {
+                metrics["ipc"] = round2(sample.get(PerfEvent::Instructions) / cycles);
+            }
+            metrics["sad_ops_per_cycle"] = round2(benchmark_result.search_stats.evaluatedTerms / cycles);
+        }
+        return metrics;
+    };
+
+    SimdIsa requested_isa = SadKernels::detectIsa();
+    if (config.simd_isa != "auto" && (!SadKernels::parseIsa(config.simd_isa, requested_isa) ||
+                                      !SadKernels::isSupported(requested_isa)))
+    {
+        std::cerr << "SIMD ISA " << config.simd_isa << " not available, using "
+                  << SadKernels::isaName(SadKernels::detectIsa()) << std::endl;
+        requested_isa = SadKernels::detectIsa();
+    }
+    SadKernels::setActive(requested_isa);
+    result["simd_isa"] = SadKernels::active().name;
+
+    SearchOptions search_options;
+    search_options.earlyAbandon = config.early_abandon;
+    search_options.shareGlobalBest = config.share_global_best;
+    search_options.lowerBounds = config.lower_bounds;
+    if (!parseDistanceMetric(config.metric, search_options.metric))
+    {
+        std::cerr << "Distance metric " << config.metric << " not available, using sad" << std::endl;
+    }
+    result["metric"] = distanceMetricName(search_options.metric);
+    if (!parseDistanceEngine(config.engine, search_options.engine))
+    {
+        std::cerr << "Distance engine " << config.engine << " not available, using auto" << std::endl;
+    }
+
+    // Contatori della cascata di lower bound (per livello)
+    auto cascade_counters = [](const SearchStats &stats)
+    {
+        return nlohmann::json{
+            {"series_total", stats.seriesTotal},
+            {"series_pruned_envelope", stats.seriesPrunedEnvelope},
+            {"windows_total", stats.windowsTotal},
+            {"windows_pruned_series", stats.windowsPrunedSeries},
+            {"windows_pruned_paa", stats.windowsPrunedPaa},
+            {"windows_pruned_envelope", stats.windowsPrunedEnvelope},
+            {"windows_exact", stats.windowsExact}};
+    };
+
+    // Posizione della variante rispetto ai limiti misurati: banda sul dataset
+    // (letto una volta per query) e termini SAD valutati, come frazioni della
+    // scansione in sola lettura, della triad e del picco del kernel
+    auto roofline_metrics = [&](const BenchmarkResult &benchmark_result, size_t dataset_bytes, const MachineCeilings &ceilings)
+    {
+        double seconds = benchmark_result.mean_execution_time_ms / 1000.0;
+        if (seconds <= 0.0 || benchmark_result.num_runs <= 0)
+            return nlohmann::json::object();
+
+        double bytes_per_second = dataset_bytes / seconds;
+        double terms_per_second = static_cast<double>(benchmark_result.search_stats.evaluatedTerms) / benchmark_result.measured_runs() / seconds;
+        double flops_per_second = terms_per_second * Roofline::FLOPS_PER_SAD_TERM;
+        double intensity = flops_per_second / bytes_per_second;
+        double attainable = std::min(ceilings.sadTermsPerSecond * Roofline::FLOPS_PER_SAD_TERM, intensity * ceilings.readBytesPerSecond);
+
+        return nlohmann::json{
+            {"gb_per_s", round2(bytes_per_second / 1e9)},
+            {"gflops", round2(flops_per_second / 1e9)},
+            {"arithmetic_intensity", round2(intensity)},
+            {"read_bandwidth_fraction", round2(bytes_per_second / ceilings.readBytesPerSecond)},
+            {"triad_bandwidth_fraction", round2(bytes_per_second / ceilings.triadBytesPerSecond)},
+            {"sad_peak_fraction", round2(terms_per_second / ceilings.sadTermsPerSecond)},
+            {"roofline_fraction", round2(attainable > 0.0 ? flops_per_second / attainable : 0.0)}};
+    };
+
+    std::vector<TimeSeries> batch_queries;
+    if (config.batch_queries > 0)
+    {
+        batch_queries = make_batch_queries(datasetSoa, query, config.batch_queries);
+    }
+
+    // Ricerca approssimata: parametri fissi oppure calibrati sulle query di
+    // indice dispari; la recall viene misurata sulle altre (compresa la query
+    // del test) rispetto alla ricerca sequenziale esatta
+    bool approximate_enabled = config.approximate_stride > 0 || config.approximate_recall > 0.0;
+    ApproximateOptions approximate;
+    std::vector<TimeSeries> recall_queries;
+    std::vector<std::vector<double>> recall_references;
+    nlohmann::json approximate_setup;
+    if (approximate_enabled)
+    {
+        std::vector<TimeSeries> sample_queries = make_batch_queries(datasetSoa, query, 2 * APPROXIMATE_RECALL_QUERIES);
+        std::vector<TimeSeries> calibration_queries;
+        for (size_t q = 0; q < sample_queries.size(); ++q)
+        {
+            (q % 2 == 0 ? recall_queries : calibration_queries).push_back(sample_queries[q]);
+        }
+        for (const TimeSeries &recall_query : recall_queries)
+        {
+            recall_references.push_back(SearchEngine::searchSequentialSoA(datasetSoa, recall_query, search_options).first);
+        }
+
+        if (config.approximate_stride > 0)
+        {
+            approximate.stride = config.approximate_stride;
+        }
+        if (config.approximate_recall > 0.0)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            approximate = SearchEngine::calibrateApproximateSoA(datasetSoa, calibration_queries, config.approximate_recall,
+                                                                config.approximate_k, search_options);
+            approximate_setup["calibration_time_ms"] =
+                std::round(std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count() * 100.0) / 100.0;
+        }
+        approximate.timeBudgetMs = config.approximate_budget_ms;
+
+        approximate_setup["stride"] = approximate.stride;
+        approximate_setup["refine_candidates"] = approximate.refineCandidates;
+        approximate_setup["refine_fraction"] = approximate.refineFraction;
+        approximate_setup["time_budget_ms"] = approximate.timeBudgetMs;
+        approximate_setup["recall_target"] = config.approximate_recall;
+        approximate_setup["k"] = config.approximate_k;
+        approximate_setup["recall_queries"] = recall_queries.size();
+        result["approximate"] = approximate_setup;
+    }
+
+    HarnessOptions harness;
+    harness.warmup_runs = config.warmup_runs;
+    harness.min_runs = config.num_runs;
+    harness.max_runs = std::max(config.max_runs, config.num_runs);
+    harness.ci_target = config.ci_target;
+    harness.outlier_mad = config.outlier_mad;
+
+    result["harness"] = {
+        {"warmup_runs", harness.warmup_runs},
+        {"min_runs", harness.min_runs},
+        {"max_runs", harness.max_runs},
+        {"ci_target", harness.ci_target},
+        {"outlier_mad", harness.outlier_mad}};
+
+    std::vector<std::vector<double>> stream_feeds;
+    size_t stream_samples = 0;
+    if (config.stream_batch > 0)
+    {
+        stream_feeds = make_stream_feeds(datasetSoa);
+        for (const std::vector<double> &feed : stream_feeds)
+        {
+            stream_samples += feed.size();
+        }
+    }
+
+    BenchmarkDatasets datasets{&datasetSoa, &datasetAos};
+    datasets.compact = element_type != ElementType::Float64 ? &compact : nullptr;
+    datasets.index = config.index_block_length > 0 ? &index : nullptr;
+    datasets.approximate = approximate_enabled ? &approximate : nullptr;
+    datasets.batchQueries = config.batch_queries > 0 ? &batch_queries : nullptr;
+    datasets.streamFeeds = config.stream_batch > 0 ? &stream_feeds : nullptr;
+    datasets.streamBatch = config.stream_batch;
+    datasets.topK = config.top_k;
+
+    // Selezionate dal filtro e con gli ingressi richiesti da questo test
+    std::vector<const BenchmarkStrategy *> strategies;
+    result["benchmarks"] = nlohmann::json::array();
+    for (const BenchmarkStrategy *strategy : BenchmarkRegistry::select(config.benchmarks))
+    {
+        if (!strategy->isAvailable(datasets))
+            continue;
+        strategies.push_back(strategy);
+        result["benchmarks"].push_back(strategy->id());
+    }
+
+    // Le baseline sequenziali sono sempre misurate, anche se escluse dal
+    // filtro: sono il riferimento di speedup e sadValues di ogni layout
+    // (e la AoS è confrontata con la SoA)
     omp_set_num_threads(1);
     std::cout << "Running sequential baseline for " << test_name << std::endl;
-    
-    auto resultSoA_sequential = benchmarkSequentialSoA(datasetSoa, query, test_name, config.num_runs);
-    auto resultAoS_sequential = benchmarkSequentialAoS(datasetAos, query, test_name, config.num_runs);
+
+    auto resultSoA_sequential = benchmarkStrategy(*BenchmarkRegistry::find("soa", "sequential"), datasets, query, test_name, harness, search_options);
+    auto resultAoS_sequential = benchmarkStrategy(*BenchmarkRegistry::find("aos", "sequential"), datasets, query, test_name, harness, search_options,
+                                                  &resultSoA_sequential.sad_values);
+
+    // Verità nota dei dataset generati: ogni serie con la query piantata ha
+    // distanza minima 0 e la migliore corrispondenza è una di queste serie
+    if (!planted.empty())
+    {
+        const double tolerance = 1e-6;
+        nlohmann::json occurrences = nlohmann::json::array();
+        double max_planted_distance = 0.0;
+        bool best_is_planted = false;
+        for (const PlantedOccurrence &occurrence : planted)
+        {
+            double distance = resultSoA_sequential.sad_values[occurrence.series];
+            max_planted_distance = std::max(max_planted_distance, distance);
+            best_is_planted = best_is_planted || occurrence.series == resultSoA_sequential.best_match_index;
+            occurrences.push_back({{"series", occurrence.series}, {"position", occurrence.position}});
+        }
+
+        bool verified = max_planted_distance <= tolerance && best_is_planted;
+        result["ground_truth"] = {
+            {"planted", occurrences},
+            {"max_planted_distance", max_planted_distance},
+            {"best_match_is_planted", best_is_planted},
+            {"verified", verified}};
+
+        std::cout << "Planted queries: " << planted.size() << (verified ? " found" : " NOT found")
+                  << " (max distance " << max_planted_distance << ")" << std::endl;
+    }
+
+    // Voce del JSON di una strategia: tempi, risultato e, per le varianti
+    // parallele, confronto con la baseline dello stesso layout
+    auto strategy_json = [&](const BenchmarkStrategy &strategy, const BenchmarkResult &variant, const BenchmarkResult &baseline,
+                             int thread_count, const MachineCeilings &ceilings)
+    {
+        nlohmann::json entry = {
+            {"mean_execution_time_ms", round2(variant.mean_execution_time_ms)},
+            {"std_deviation_ms", round2(variant.std_deviation_ms)},
+            {"min_execution_time_ms", round2(variant.min_execution_time_ms)},
+            {"max_execution_time_ms", round2(variant.max_execution_time_ms)},
+            {"ci_half_width_ms", round2(variant.ci_half_width_ms)},
+            {"num_runs", variant.num_runs},
+            {"warmup_runs", variant.warmup_runs},
+            {"outliers_rejected", variant.rejected_times_ms.size()},
+            {"best_match_index", variant.best_match_index},
+            {"best_sad_value", variant.best_sad_value},
+            {"results_match_reference", variant.results_match_reference},
+            {"max_sad_difference", variant.max_sad_difference},
+            {"all_execution_times", variant.execution_times_ms}};
+
+        if (strategy.parallel)
+        {
+            double speedup = baseline.mean_execution_time_ms / variant.mean_execution_time_ms;
+            entry["speedup"] = round2(speedup);
+            entry["efficiency"] = round2(speedup / thread_count);
+            entry["results_match"] = variant.best_match_index == baseline.best_match_index;
+        }
+
+        if (!variant.rejected_times_ms.empty())
+        {
+            entry["rejected_execution_times"] = variant.rejected_times_ms;
+        }
+
+        if (!variant.thread_busy_ms.empty())
+        {
+            entry["load_imbalance"] = round2(variant.load_imbalance);
+            entry["thread_busy_ms"] = variant.thread_busy_ms;
+        }
+
+        if (config.early_abandon || config.lower_bounds)
+        {
+            entry["pruned_fraction"] = round2(variant.pruned_fraction);
+        }
+
+        if (config.lower_bounds)
+        {
+            entry["lower_bounds"] = cascade_counters(variant.search_stats);
+        }
+
+        if (config.track_allocations)
+        {
+            entry["allocations_per_query"] = variant.allocations_per_query;
+        }
+
+        size_t dataset_bytes = strategy.layout == "aos" ? datasetAos.sizeInBytes() : datasetSoa.sizeInBytes();
+        if (perf_enabled)
+        {
+            entry["perf"] = perf_metrics(variant, dataset_bytes);
+        }
+
+        if (config.roofline)
+        {
+            entry["roofline"] = roofline_metrics(variant, dataset_bytes, ceilings);
+        }
+        return entry;
+    };
+
+    // Dettagli propri delle strategie con ingressi opzionali
+    auto strategy_details = [&](const BenchmarkStrategy &strategy, const BenchmarkResult &variant, int thread_count, nlohmann::json &entry)
+    {
+        double seconds = variant.mean_execution_time_ms / 1000.0;
+        if (strategy.name == "top_k")
+        {
+            // Le k corrispondenze, fuori dalla misura
+            nlohmann::json matches = nlohmann::json::array();
+            for (const Match &match : SearchEngine::searchTopKSoA(datasetSoa, query, config.top_k, search_options))
+            {
+                matches.push_back({{"series_index", match.seriesIndex}, {"offset", match.offset}, {"sad", match.sad}});
+            }
+            entry["k"] = config.top_k;
+            entry["matches"] = matches;
+        }
+        else if (strategy.name == "batch" || strategy.name == "batch_independent")
+        {
+            // Ogni esecuzione cerca tutte le query: speedup per query
+            entry["num_queries"] = batch_queries.size();
+            entry["queries_per_second"] = seconds > 0.0 ? round2(batch_queries.size() / seconds) : 0.0;
+            entry["speedup"] = round2(resultSoA_sequential.mean_execution_time_ms * batch_queries.size() / variant.mean_execution_time_ms);
+            entry["efficiency"] = round2(entry["speedup"].get<double>() / thread_count);
+        }
+        else if (strategy.name == "streaming")
+        {
+            entry["batch_size"] = config.stream_batch;
+            entry["samples_per_second"] = seconds > 0.0 ? std::round(stream_samples / seconds) : 0.0;
+        }
+        else if (strategy.name == "compact" || strategy.name == "compact_estimate")
+        {
+            entry["element_type"] = elementTypeName(element_type);
+            entry["compact_bytes"] = compact.sizeInBytes();
+            entry["compression_ratio"] = round2(static_cast<double>(datasetSoa.sizeInBytes()) / std::max<size_t>(compact.sizeInBytes(), 1));
+            if (strategy.name == "compact")
+            {
+                // Serie ricalcolate in double rispetto a quelle stimate
+                const SearchStats &stats = variant.search_stats;
+                entry["reranked_fraction"] = stats.seriesTotal > 0 ? static_cast<double>(stats.seriesReranked) / stats.seriesTotal : 0.0;
+            }
+        }
+        else if (strategy.name == "indexed")
+        {
+            const SearchStats &stats = variant.search_stats;
+            entry["block_length"] = index.getBlockLength();
+            entry["windows_pruned_by_index"] = stats.totalTerms > 0
+                                                   ? round2(static_cast<double>(stats.windowsPrunedIndex * query.getSize()) / stats.totalTerms)
+                                                   : 0.0;
+        }
+        else if (strategy.name == "approximate")
+        {
+            // Recall sulle query di verifica, fuori dalla misura
+            double recall_at_1 = 0.0;
+            double recall_at_k = 0.0;
+            for (size_t q = 0; q < recall_queries.size(); ++q)
+            {
+                std::vector<double> approximate_values =
+                    SearchEngine::searchApproximateSoA(datasetSoa, recall_queries[q], approximate, search_options).first;
+                recall_at_1 += SearchEngine::recallAtK(recall_references[q], approximate_values, 1);
+                recall_at_k += SearchEngine::recallAtK(recall_references[q], approximate_values, config.approximate_k);
+            }
+            entry["stride"] = approximate.stride;
+            entry["refine_fraction"] = approximate.refineFraction;
+            entry["recall_at_1"] = round2(recall_at_1 / std::max<size_t>(recall_queries.size(), 1));
+            entry["recall_at_k"] = round2(recall_at_k / std::max<size_t>(recall_queries.size(), 1));
+            entry["k"] = config.approximate_k;
+        }
+    };
 
     for (int thread_count : config.thread_counts)
     {
         omp_set_num_threads(thread_count);
+        if (threads_bound)
+        {
+            NumaPlacement::bindThreads(affinity);
+        }
         std::cout << "\nRunning benchmark for " << test_name
                   << " with " << thread_count << " threads (" << config.num_runs << " runs each):" << std::endl;
 
         nlohmann::json thread_result;
 
-        if (thread_count == 1)
-        {
-            // Per 1 thread, usa i risultati sequenziali già calcolati
-            thread_result["soa"] = {
-                {"sequential", {
-                    {"mean_execution_time_ms", round2(resultSoA_sequential.mean_execution_time_ms)}, 
-                    {"std_deviation_ms", round2(resultSoA_sequential.std_deviation_ms)}, 
-                    {"min_execution_time_ms", round2(resultSoA_sequential.min_execution_time_ms)}, 
-                    {"max_execution_time_ms", round2(resultSoA_sequential.max_execution_time_ms)}, 
-                    {"best_match_index", resultSoA_sequential.best_match_index}, 
-                    {"best_sad_value", resultSoA_sequential.best_sad_value}, 
-                    {"all_execution_times", resultSoA_sequential.execution_times_ms}
-                }}
-            };
-
-            thread_result["aos"] = {
-                {"sequential", {
-                    {"mean_execution_time_ms", round2(resultAoS_sequential.mean_execution_time_ms)}, 
-                    {"std_deviation_ms", round2(resultAoS_sequential.std_deviation_ms)}, 
-                    {"min_execution_time_ms", round2(resultAoS_sequential.min_execution_time_ms)}, 
-                    {"max_execution_time_ms", round2(resultAoS_sequential.max_execution_time_ms)}, 
-                    {"best_match_index", resultAoS_sequential.best_match_index}, 
-                    {"best_sad_value", resultAoS_sequential.best_sad_value}, 
-                    {"all_execution_times", resultAoS_sequential.execution_times_ms}
-                }}
-            };
+        // Tempo medio di una strategia in questo passo (0 se non misurata)
+        auto mean_time = [&](const std::string &layout, const std::string &name)
+        {
+            return thread_result.contains(layout) && thread_result[layout].contains(name)
+                       ? thread_result[layout][name]["mean_execution_time_ms"].get<double>()
+                       : 0.0;
+        };
+
+        MachineCeilings ceilings;
+        if (config.roofline)
+        {
+            std::cout << "Measuring bandwidth and SAD peak with " << thread_count << " threads" << std::endl;
+            ceilings = Roofline::measure(SadKernels::active());
+            thread_result["roofline"] = {
+                {"array_mb", to_mb(ceilings.arrayBytes)},
+                {"triad_gb_per_s", round2(ceilings.triadBytesPerSecond / 1e9)},
+                {"read_gb_per_s", round2(ceilings.readBytesPerSecond / 1e9)},
+                {"sad_gterms_per_s", round2(ceilings.sadTermsPerSecond / 1e9)},
+                {"peak_gflops", round2(ceilings.sadTermsPerSecond * Roofline::FLOPS_PER_SAD_TERM / 1e9)},
+                {"ridge_intensity", round2(ceilings.sadTermsPerSecond * Roofline::FLOPS_PER_SAD_TERM / ceilings.readBytesPerSecond)}};
         }
-        else
+
+        // Con un thread le strategie sequenziali, altrimenti quelle parallele
+        // (più quelle misurate a ogni numero di thread)
+        for (const BenchmarkStrategy *strategy : strategies)
         {
-            auto resultSoA_parallelOuter = benchmarkSoA_parallelOuter(datasetSoa, query, test_name, config.num_runs);
-            auto resultSoA_parallelInner = benchmarkSoA_parallelInner(datasetSoa, query, test_name, config.num_runs);
-            auto resultAoS_parallelOuter = benchmarkAoS_parallelOuter(datasetAos, query, test_name, config.num_runs);
-            auto resultAoS_parallelInner = benchmarkAoS_parallelInner(datasetAos, query, test_name, config.num_runs);
-
-            double soa_outer_speedup = resultSoA_sequential.mean_execution_time_ms / resultSoA_parallelOuter.mean_execution_time_ms;
-            double soa_inner_speedup = resultSoA_sequential.mean_execution_time_ms / resultSoA_parallelInner.mean_execution_time_ms;
-            double aos_outer_speedup = resultAoS_sequential.mean_execution_time_ms / resultAoS_parallelOuter.mean_execution_time_ms;
-            double aos_inner_speedup = resultAoS_sequential.mean_execution_time_ms / resultAoS_parallelInner.mean_execution_time_ms;
-
-            double soa_outer_efficiency = soa_outer_speedup / thread_count;
-            double soa_inner_efficiency = soa_inner_speedup / thread_count;
-            double aos_outer_efficiency = aos_outer_speedup / thread_count;
-            double aos_inner_efficiency = aos_inner_speedup / thread_count;
-
-            thread_result["soa"] = {
-                {"parallel_outer", {
-                    {"mean_execution_time_ms", round2(resultSoA_parallelOuter.mean_execution_time_ms)}, 
-                    {"std_deviation_ms", round2(resultSoA_parallelOuter.std_deviation_ms)}, 
-                    {"min_execution_time_ms", round2(resultSoA_parallelOuter.min_execution_time_ms)}, 
-                    {"max_execution_time_ms", round2(resultSoA_parallelOuter.max_execution_time_ms)}, 
-                    {"speedup", round2(soa_outer_speedup)}, 
-                    {"efficiency", round2(soa_outer_efficiency)}, 
-                    {"best_match_index", resultSoA_parallelOuter.best_match_index}, 
-                    {"best_sad_value", resultSoA_parallelOuter.best_sad_value}, 
-                    {"results_match", resultSoA_parallelOuter.best_match_index == resultSoA_sequential.best_match_index}, 
-                    {"all_execution_times", resultSoA_parallelOuter.execution_times_ms}
-                }},
-                {"parallel_inner", {
-                    {"mean_execution_time_ms", round2(resultSoA_parallelInner.mean_execution_time_ms)}, 
-                    {"std_deviation_ms", round2(resultSoA_parallelInner.std_deviation_ms)}, 
-                    {"min_execution_time_ms", round2(resultSoA_parallelInner.min_execution_time_ms)}, 
-                    {"max_execution_time_ms", round2(resultSoA_parallelInner.max_execution_time_ms)}, 
-                    {"speedup", round2(soa_inner_speedup)}, 
-                    {"efficiency", round2(soa_inner_efficiency)}, 
-                    {"best_match_index", resultSoA_parallelInner.best_match_index}, 
-                    {"best_sad_value", resultSoA_parallelInner.best_sad_value}, 
-                    {"results_match", resultSoA_parallelInner.best_match_index == resultSoA_sequential.best_match_index}, 
-                    {"all_execution_times", resultSoA_parallelInner.execution_times_ms}
-                }}
-            };
-
-            thread_result["aos"] = {
-                {"parallel_outer", {
-                    {"mean_execution_time_ms", round2(resultAoS_parallelOuter.mean_execution_time_ms)}, 
-                    {"std_deviation_ms", round2(resultAoS_parallelOuter.std_deviation_ms)}, 
-                    {"min_execution_time_ms", round2(resultAoS_parallelOuter.min_execution_time_ms)}, 
-                    {"max_execution_time_ms", round2(resultAoS_parallelOuter.max_execution_time_ms)}, 
-                    {"speedup", round2(aos_outer_speedup)}, 
-                    {"efficiency", round2(aos_outer_efficiency)}, 
-                    {"best_match_index", resultAoS_parallelOuter.best_match_index}, 
-                    {"best_sad_value", resultAoS_parallelOuter.best_sad_value}, 
-                    {"results_match", resultAoS_parallelOuter.best_match_index == resultAoS_sequential.best_match_index}, 
-                    {"all_execution_times", resultAoS_parallelOuter.execution_times_ms}
-                }},
-                {"parallel_inner", {
-                    {"mean_execution_time_ms", round2(resultAoS_parallelInner.mean_execution_time_ms)}, 
-                    {"std_deviation_ms", round2(resultAoS_parallelInner.std_deviation_ms)}, 
-                    {"min_execution_time_ms", round2(resultAoS_parallelInner.min_execution_time_ms)}, 
-                    {"max_execution_time_ms", round2(resultAoS_parallelInner.max_execution_time_ms)}, 
-                    {"speedup", round2(aos_inner_speedup)}, 
-                    {"efficiency", round2(aos_inner_efficiency)}, 
-                    {"best_match_index", resultAoS_parallelInner.best_match_index}, 
-                    {"best_sad_value", resultAoS_parallelInner.best_sad_value}, 
-                    {"results_match", resultAoS_parallelInner.best_match_index == resultAoS_sequential.best_match_index}, 
-                    {"all_execution_times", resultAoS_parallelInner.execution_times_ms}
-                }}
-            };
-        }
-
-        if (thread_count > 1)
-        {
-            double soa_vs_aos_outer = thread_result["aos"]["parallel_outer"]["mean_execution_time_ms"].get<double>() /
-                                      thread_result["soa"]["parallel_outer"]["mean_execution_time_ms"].get<double>();
-            double soa_vs_aos_inner = thread_result["aos"]["parallel_inner"]["mean_execution_time_ms"].get<double>() /
-                                      thread_result["soa"]["parallel_inner"]["mean_execution_time_ms"].get<double>();
-
-            thread_result["analysis"] = {
-                {"soa_vs_aos_parallel_outer", round2(soa_vs_aos_outer)},
-                {"soa_vs_aos_parallel_inner", round2(soa_vs_aos_inner)}
-            };
+            if (!strategy->allThreadCounts && strategy->parallel != (thread_count > 1))
+                continue;
+
+            const BenchmarkResult &baseline = strategy->layout == "aos" ? resultAoS_sequential : resultSoA_sequential;
+            if (!strategy->parallel && strategy->name == "sequential")
+            {
+                // Baseline già misurata
+                thread_result[strategy->layout][strategy->name] = strategy_json(*strategy, baseline, baseline, thread_count, ceilings);
+                continue;
+            }
+
+            BenchmarkResult variant = benchmarkStrategy(*strategy, datasets, query, test_name, harness, search_options, &baseline.sad_values);
+            nlohmann::json entry = strategy_json(*strategy, variant, baseline, thread_count, ceilings);
+            strategy_details(*strategy, variant, thread_count, entry);
+
+            // Ricerche che evitano parte della scansione, rispetto a quella
+            // completa se misurata in questo passo
+            if ((strategy->name == "indexed" || strategy->name == "approximate") &&
+                mean_time("soa", "parallel_outer") > 0.0 && variant.mean_execution_time_ms > 0.0)
+            {
+                entry["speedup_vs_parallel_outer"] = round2(mean_time("soa", "parallel_outer") / variant.mean_execution_time_ms);
+            }
+            thread_result[strategy->layout][strategy->name] = entry;
         }
-        else
+
+        // Il batch contro le stesse query cercate una alla volta
+        double batch_time = mean_time("soa", "batch");
+        double independent_time = mean_time("soa", "batch_independent");
+        if (batch_time > 0.0 && independent_time > 0.0)
+        {
+            thread_result["soa"]["batch"]["speedup_vs_independent"] = round2(independent_time / batch_time);
+        }
+
+        if (config.fft_crossover)
+        {
+            thread_result["soa"]["fft_crossover"] = fft_crossover(datasetSoa, test_name, harness, search_options);
+        }
+
+        if (config.matrix_profile)
         {
-            double soa_vs_aos_sequential = resultAoS_sequential.mean_execution_time_ms / resultSoA_sequential.mean_execution_time_ms;
-            thread_result["analysis"] = {
-                {"soa_vs_aos_sequential", round2(soa_vs_aos_sequential)}
-            };
+            thread_result["soa"]["matrix_profile"] = matrix_profile(datasetSoa, query.getSize(), config.num_runs);
         }
 
+        nlohmann::json analysis = nlohmann::json::object();
+        for (const BenchmarkStrategy *strategy : strategies)
+        {
+            double soa_time = mean_time("soa", strategy->name);
+            double aos_time = mean_time("aos", strategy->name);
+            if (strategy->layout == "soa" && soa_time > 0.0 && aos_time > 0.0)
+            {
+                analysis["soa_vs_aos_" + strategy->name] = round2(aos_time / soa_time);
+            }
+        }
+
+        // Collapsed rispetto alla migliore tra outer e inner per questa forma del dataset
+        double soa_outer_time = mean_time("soa", "parallel_outer");
+        double soa_inner_time = mean_time("soa", "parallel_inner");
+        double soa_collapsed_time = mean_time("soa", "parallel_collapsed");
+        if (soa_outer_time > 0.0 && soa_inner_time > 0.0 && soa_collapsed_time > 0.0)
+        {
+            analysis["soa_collapsed_vs_best_outer_inner"] = round2(std::min(soa_outer_time, soa_inner_time) / soa_collapsed_time);
+        }
+        thread_result["analysis"] = analysis;
+
         result["thread_results"][std::to_string(thread_count)] = thread_result;
     }
 
@@ -561,6 +1213,8 @@ nlohmann::json Benchmark::run_test(const TestConfiguration &config)
         {"tested_thread_counts", config.thread_counts}
     };
 
+    AllocationCounter::setEnabled(false);
+
     return result;
 }
 
@@ -0,0 +1,487 @@
+#include "../include/BenchmarkConfig.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <omp.h>
+#include <sstream>
+#include <tuple>
+#include <type_traits>
+
+namespace
+{
+    // Unico elenco dei campi configurabili, usato sia in lettura sia in scrittura
+    template <typename Visitor>
+    void visitFields(TestConfiguration &config, Visitor &&visit)
+    {
+        visit("num_series", config.num_series);
+        visit("series_length", config.series_length);
+        visit("query_length", config.query_length);
+        visit("num_runs", config.num_runs);
+        visit("thread_counts", config.thread_counts);
+        visit("dataset_path", config.dataset_path);
+        visit("query_path", config.query_path);
+        visit("generator", config.generator);
+        visit("seed", config.seed);
+        visit("planted_queries", config.planted_queries);
+        visit("soa_layout", config.soa_layout);
+        visit("aos_layout", config.aos_layout);
+        visit("track_allocations", config.track_allocations);
+        visit("simd_isa", config.simd_isa);
+        visit("early_abandon", config.early_abandon);
+        visit("share_global_best", config.share_global_best);
+        visit("lower_bounds", config.lower_bounds);
+        visit("metric", config.metric);
+        visit("engine", config.engine);
+        visit("fft_crossover", config.fft_crossover);
+        visit("matrix_profile", config.matrix_profile);
+        visit("top_k", config.top_k);
+        visit("batch_queries", config.batch_queries);
+        visit("stream_batch", config.stream_batch);
+        visit("binary_cache", config.binary_cache);
+        visit("numa_policy", config.numa_policy);
+        visit("omp_places", config.omp_places);
+        visit("proc_bind", config.proc_bind);
+        visit("element_type", config.element_type);
+        visit("index_block_length", config.index_block_length);
+        visit("approximate_stride", config.approximate_stride);
+        visit("approximate_recall", config.approximate_recall);
+        visit("approximate_budget_ms", config.approximate_budget_ms);
+        visit("approximate_k", config.approximate_k);
+        visit("perf_counters", config.perf_counters);
+        visit("roofline", config.roofline);
+        visit("benchmarks", config.benchmarks);
+        visit("warmup_runs", config.warmup_runs);
+        visit("max_runs", config.max_runs);
+        visit("ci_target", config.ci_target);
+        visit("outlier_mad", config.outlier_mad);
+    }
+
+    // Nomi brevi accettati sulla riga di comando
+    const std::map<std::string, std::string> ALIASES = {
+        {"runs", "num_runs"},
+        {"threads", "thread_counts"},
+        {"warmup", "warmup_runs"},
+        {"dataset", "dataset_path"},
+        {"query", "query_path"}};
+
+    bool isKnownKey(const std::string &key)
+    {
+        TestConfiguration config;
+        bool known = false;
+        visitFields(config, [&](const char *name, auto &)
+                    { known = known || key == name; });
+        return known;
+    }
+
+    std::vector<std::string> split(const std::string &text, char separator)
+    {
+        std::vector<std::string> parts;
+        std::stringstream stream(text);
+        std::string part;
+        while (std::getline(stream, part, separator))
+        {
+            if (!part.empty())
+                parts.push_back(part);
+        }
+        return parts;
+    }
+
+    // "1000x100x50" -> num_series, series_length, query_length
+    bool parseShape(const std::string &text, TestConfiguration &config)
+    {
+        std::vector<std::string> parts = split(text, 'x');
+        if (parts.size() != 3)
+            return false;
+        try
+        {
+            config.num_series = std::stoi(parts[0]);
+            config.series_length = std::stoi(parts[1]);
+            config.query_length = std::stoi(parts[2]);
+        }
+        catch (const std::exception &)
+        {
+            return false;
+        }
+        return config.num_series > 0 && config.series_length > 0 && config.query_length > 0;
+    }
+
+    // Valore di un'opzione --chiave=valore come JSON: lista di interi per
+    // thread_counts, JSON valido se possibile (numeri, booleani), altrimenti stringa
+    nlohmann::json optionValue(const std::string &key, const std::string &text, bool asString)
+    {
+        if (key == "thread_counts")
+        {
+            nlohmann::json counts = nlohmann::json::array();
+            for (const std::string &part : split(text, ','))
+            {
+                try
+                {
+                    counts.push_back(std::stoi(part));
+                }
+                catch (const std::exception &)
+                {
+                    return text;
+                }
+            }
+            return counts;
+        }
+        if (asString)
+            return text;
+        nlohmann::json value = nlohmann::json::parse(text, nullptr, false);
+        return value.is_discarded() ? nlohmann::json(text) : value;
+    }
+
+    bool validate(const TestConfiguration &config, std::string &error)
+    {
+        if (config.dataset_path.empty() != config.query_path.empty())
+        {
+            error = "dataset_path and query_path must be given together";
+            return false;
+        }
+        if (config.dataset_path.empty() && (config.num_series <= 0 || config.series_length <= 0 || config.query_length <= 0))
+        {
+            error = "each test needs num_series, series_length and query_length (or dataset_path and query_path)";
+            return false;
+        }
+        if (config.generator != "native" && config.generator != "python")
+        {
+            error = "generator must be native or python";
+            return false;
+        }
+        if (config.planted_queries < 0 || config.planted_queries > config.num_series ||
+            (config.planted_queries > 0 && config.query_length > config.series_length))
+        {
+            error = "planted_queries must be between 0 and num_series, with query_length <= series_length";
+            return false;
+        }
+        if (config.num_runs < 1)
+        {
+            error = "num_runs must be at least 1";
+            return false;
+        }
+        for (int threads : config.thread_counts)
+        {
+            if (threads < 1)
+            {
+                error = "thread counts must be at least 1";
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+std::vector<int> BenchmarkConfig::defaultThreadCounts(int maxThreads)
+{
+    std::vector<int> counts;
+    for (int threads = 1; threads <= maxThreads; threads *= 2)
+    {
+        counts.push_back(threads);
+    }
+    if (counts.empty() || counts.back() != maxThreads)
+    {
+        counts.push_back(std::max(maxThreads, 1));
+    }
+    return counts;
+}
+
+std::vector<TestConfiguration> BenchmarkConfig::defaultTests()
+{
+    // configurazione dei test: num_series, series_length, query_length
+    const std::vector<std::tuple<int, int, int>> test_cases = {
+        {1000, 100, 50},
+        {5000, 100, 50},
+
+        {10, 5000, 50},
+        {5, 10000, 50},
+    };
+
+    std::vector<TestConfiguration> tests;
+    for (const auto &[num_series, series_length, query_length] : test_cases)
+    {
+        TestConfiguration config;
+        config.num_series = num_series;
+        config.series_length = series_length;
+        config.query_length = query_length;
+        tests.push_back(config);
+    }
+    return tests;
+}
+
+nlohmann::json BenchmarkConfig::toJson(const TestConfiguration &config)
+{
+    TestConfiguration copy = config;
+    nlohmann::json options = nlohmann::json::object();
+    visitFields(copy, [&](const char *key, auto &field)
+                {
+        if constexpr (std::is_same_v<std::decay_t<decltype(field)>, StorageLayout>)
+            options[key] = storageLayoutName(field);
+        else
+            options[key] = field; });
+    return options;
+}
+
+bool BenchmarkConfig::applyJson(const nlohmann::json &options, TestConfiguration &config, std::string &error)
+{
+    if (!options.is_object())
+    {
+        error = "test configuration must be a JSON object";
+        return false;
+    }
+    for (const auto &[key, value] : options.items())
+    {
+        if (!isKnownKey(key))
+        {
+            error = "unknown option " + key;
+            return false;
+        }
+    }
+
+    bool valid = true;
+    visitFields(config, [&](const char *key, auto &field)
+                {
+        auto it = options.find(key);
+        if (!valid || it == options.end())
+            return;
+
+        using Field = std::decay_t<decltype(field)>;
+        try
+        {
+            if constexpr (std::is_same_v<Field, StorageLayout>)
+            {
+                valid = parseStorageLayout(it->template get<std::string>(), field);
+            }
+            else if constexpr (std::is_same_v<Field, bool>)
+            {
+                valid = it->is_boolean();
+                if (valid)
+                    field = it->template get<bool>();
+            }
+            else if constexpr (std::is_arithmetic_v<Field>)
+            {
+                valid = it->is_number();
+                if (valid)
+                    field = it->template get<Field>();
+            }
+            else
+            {
+                field = it->template get<Field>();
+            }
+        }
+        catch (const nlohmann::json::exception &)
+        {
+            valid = false;
+        }
+
+        if (!valid)
+            error = "invalid value for " + std::string(key) + ": " + it->dump(); });
+    return valid;
+}
+
+bool BenchmarkConfig::parseArguments(int argc, char **argv, BenchmarkPlan &plan, std::string &error)
+{
+    TestConfiguration base;
+    std::vector<TestConfiguration> tests; // vuoto: forme storiche con i default
+    nlohmann::json overrides = nlohmann::json::object();
+    std::vector<std::string> layouts;
+
+    // Il file di configurazione viene letto per primo, indipendentemente
+    // dalla posizione: le altre opzioni lo sovrascrivono
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg.compare(0, 9, "--config=") != 0)
+            continue;
+
+        std::string path = arg.substr(9);
+        std::ifstream file(path);
+        nlohmann::json document = file.is_open() ? nlohmann::json::parse(file, nullptr, false) : nlohmann::json();
+        if (!file.is_open() || document.is_discarded() || !document.is_object())
+        {
+            error = "cannot read configuration file " + path;
+            return false;
+        }
+
+        if (document.contains("output"))
+        {
+            if (!document["output"].is_string())
+            {
+                error = "invalid value for output: " + document["output"].dump();
+                return false;
+            }
+            plan.output_path = document["output"].get<std::string>();
+        }
+        if (document.contains("defaults") && !applyJson(document["defaults"], base, error))
+            return false;
+
+        if (document.contains("tests"))
+        {
+            if (!document["tests"].is_array())
+            {
+                error = "invalid value for tests: expected a JSON array";
+                return false;
+            }
+            tests.clear();
+            for (const nlohmann::json &test : document["tests"])
+            {
+                // File dei risultati: il test si riesegue dalla sua "configuration"
+                const nlohmann::json &options = test.is_object() && test.contains("configuration") ? test["configuration"] : test;
+                TestConfiguration config = base;
+                if (!applyJson(options, config, error))
+                    return false;
+                tests.push_back(config);
+            }
+        }
+    }
+
+    std::vector<TestConfiguration> shapes;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg.compare(0, 2, "--") != 0)
+        {
+            error = "unexpected argument " + arg;
+            return false;
+        }
+
+        size_t equals = arg.find('=');
+        std::string name = arg.substr(2, equals == std::string::npos ? std::string::npos : equals - 2);
+        std::string text = equals == std::string::npos ? "" : arg.substr(equals + 1);
+
+        if (name == "config")
+            continue;
+        if (name == "help")
+        {
+            plan.help = true;
+            return true;
+        }
+        if (name == "list-benchmarks")
+        {
+            plan.list_benchmarks = true;
+            continue;
+        }
+        if (name == "output")
+        {
+            plan.output_path = text;
+            continue;
+        }
+        if (name == "tests")
+        {
+            for (const std::string &shape : split(text, ','))
+            {
+                TestConfiguration config = base;
+                if (!parseShape(shape, config))
+                {
+                    error = "invalid test shape " + shape + " (expected NUM_SERIESxSERIES_LENGTHxQUERY_LENGTH)";
+                    return false;
+                }
+                shapes.push_back(config);
+            }
+            continue;
+        }
+        if (name == "layouts")
+        {
+            layouts = split(text, ',');
+            continue;
+        }
+
+        std::string key = name;
+        std::replace(key.begin(), key.end(), '-', '_');
+        auto alias = ALIASES.find(key);
+        if (alias != ALIASES.end())
+            key = alias->second;
+        if (!isKnownKey(key))
+        {
+            error = "unknown option --" + name;
+            return false;
+        }
+
+        // --flag senza valore vale true; i valori non validi come JSON sono stringhe
+        nlohmann::json value = equals == std::string::npos ? nlohmann::json(true) : optionValue(key, text, false);
+        TestConfiguration probe = base;
+        if (!applyJson({{key, value}}, probe, error))
+        {
+            value = optionValue(key, text, true);
+            std::string string_error;
+            if (!applyJson({{key, value}}, probe, string_error))
+                return false;
+        }
+        overrides[key] = value;
+    }
+
+    // --dataset/--query sostituiscono le forme generate con un solo test sui file
+    if (overrides.contains("dataset_path"))
+    {
+        shapes.assign(1, base);
+    }
+    if (!shapes.empty())
+    {
+        tests = shapes;
+    }
+    else if (tests.empty())
+    {
+        for (const TestConfiguration &shape : defaultTests())
+        {
+            TestConfiguration config = base;
+            config.num_series = shape.num_series;
+            config.series_length = shape.series_length;
+            config.query_length = shape.query_length;
+            tests.push_back(config);
+        }
+    }
+
+    int processors = omp_get_num_procs();
+    plan.tests.clear();
+    for (TestConfiguration config : tests)
+    {
+        applyJson(overrides, config, error);
+        if (config.thread_counts.empty())
+        {
+            config.thread_counts = defaultThreadCounts(processors);
+        }
+
+        // Strategie dei layout non richiesti escluse dal filtro
+        for (const std::string &layout : {std::string("soa"), std::string("aos")})
+        {
+            if (!layouts.empty() && std::find(layouts.begin(), layouts.end(), layout) == layouts.end())
+            {
+                config.benchmarks += (config.benchmarks.empty() ? "-" : ",-") + layout + ".*";
+            }
+        }
+
+        if (!validate(config, error))
+            return false;
+        plan.tests.push_back(config);
+    }
+
+    for (int threads : plan.tests.empty() ? std::vector<int>() : plan.tests[0].thread_counts)
+    {
+        if (threads > processors)
+        {
+            std::cerr << "Warning: " << threads << " threads requested on " << processors << " processors" << std::endl;
+        }
+    }
+
+    error.clear();
+    return true;
+}
+
+std::string BenchmarkConfig::usage(const std::string &program)
+{
+    std::ostringstream text;
+    text << "Usage: " << program << " [options]\n"
+         << "  --config=FILE          JSON file {\"output\", \"defaults\", \"tests\": [...]} or a results file to rerun\n"
+         << "  --tests=NxLxQ,...      dataset shapes (series x length x query length)\n"
+         << "  --dataset=CSV --query=CSV  run on existing files instead of generated ones\n"
+         << "  --generator=native|python --seed=N --planted-queries=N  synthetic dataset (default native, in memory)\n"
+         << "  --threads=1,2,4        thread counts (default: powers of two up to " << omp_get_num_procs() << ")\n"
+         << "  --runs=N               timed runs per strategy (default 10)\n"
+         << "  --benchmarks=FILTER    strategies, e.g. \"soa.*,-soa.parallel_tasks\" or \"*.parallel_outer\"\n"
+         << "  --layouts=soa,aos      only strategies on these layouts\n"
+         << "  --output=PATH          results file (default output/benchmark_results/parallelization_analysis.json)\n"
+         << "  --list-benchmarks      print the registered strategies and exit\n"
+         << "  --warmup=N --max-runs=N --ci-target=X --outlier-mad=X  repetition control\n"
+         << "  --<field>=VALUE        any other TestConfiguration field, e.g. --early-abandon --metric=chebyshev\n";
+    return text.str();
+}
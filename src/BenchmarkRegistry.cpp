@@ -0,0 +1,287 @@
+#include "../include/BenchmarkRegistry.h"
+#include "../include/StreamingSearch.h"
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+namespace
+{
+    using SoASearch = std::pair<std::vector<double>, size_t> (*)(const TimeSeriesSoA &, const TimeSeries &, const SearchOptions &);
+    using AoSSearch = std::pair<std::vector<double>, size_t> (*)(const TimeSeriesAoS &, const TimeSeries &, const SearchOptions &);
+
+    BenchmarkStrategy namedStrategy(const std::string &layout, const std::string &name, const std::string &label, bool parallel)
+    {
+        BenchmarkStrategy strategy;
+        strategy.layout = layout;
+        strategy.name = name;
+        strategy.label = label;
+        strategy.parallel = parallel;
+        return strategy;
+    }
+
+    BenchmarkStrategy soaStrategy(const std::string &name, const std::string &label, bool parallel, SoASearch search)
+    {
+        BenchmarkStrategy strategy = namedStrategy("soa", name, label, parallel);
+        strategy.search = [search](const BenchmarkDatasets &datasets, const TimeSeries &query, const SearchOptions &options)
+        {
+            return search(*datasets.soa, query, options);
+        };
+        return strategy;
+    }
+
+    BenchmarkStrategy aosStrategy(const std::string &name, const std::string &label, bool parallel, AoSSearch search)
+    {
+        BenchmarkStrategy strategy = namedStrategy("aos", name, label, parallel);
+        strategy.search = [search](const BenchmarkDatasets &datasets, const TimeSeries &query, const SearchOptions &options)
+        {
+            return search(*datasets.aos, query, options);
+        };
+        return strategy;
+    }
+
+    // Varianti SoA che richiedono ingressi opzionali del test (BenchmarkDatasets):
+    // misurate a ogni numero di thread, anche 1
+    BenchmarkStrategy optionalSoaStrategy(const std::string &name, const std::string &label, ResultCheck check,
+                                          std::function<bool(const BenchmarkDatasets &)> available)
+    {
+        BenchmarkStrategy strategy = namedStrategy("soa", name, label, true);
+        strategy.check = check;
+        strategy.allThreadCounts = true;
+        strategy.available = std::move(available);
+        return strategy;
+    }
+
+    // Distanza per serie come le altre strategie: quella del miglior match
+    // della serie tra i k, max() per le serie senza match
+    BenchmarkStrategy topKStrategy()
+    {
+        BenchmarkStrategy strategy = optionalSoaStrategy("top_k", "Top-K SoA", ResultCheck::BestMatch,
+                                                         [](const BenchmarkDatasets &datasets)
+                                                         { return datasets.topK > 0; });
+        strategy.search = [](const BenchmarkDatasets &datasets, const TimeSeries &query, const SearchOptions &options)
+        {
+            std::vector<Match> matches = SearchEngine::searchTopKSoA(*datasets.soa, query, datasets.topK, options);
+            std::vector<double> sadValues(datasets.soa->getNumSeries(), std::numeric_limits<double>::max());
+            for (const Match &match : matches)
+            {
+                sadValues[match.seriesIndex] = std::min(sadValues[match.seriesIndex], match.sad);
+            }
+            size_t bestIndex = matches.empty() ? 0 : matches.front().seriesIndex;
+            return std::make_pair(std::move(sadValues), bestIndex);
+        };
+        return strategy;
+    }
+
+    // N query: un passaggio a blocchi sul dataset oppure N chiamate a
+    // searchParallelSoAOuter; il risultato è quello della query del test
+    BenchmarkStrategy batchStrategy(const std::string &name, const std::string &label, bool batched)
+    {
+        BenchmarkStrategy strategy = optionalSoaStrategy(name, label, ResultCheck::AllValues,
+                                                         [](const BenchmarkDatasets &datasets)
+                                                         { return datasets.batchQueries != nullptr && !datasets.batchQueries->empty(); });
+        strategy.search = [batched](const BenchmarkDatasets &datasets, const TimeSeries &, const SearchOptions &options)
+        {
+            std::vector<std::pair<std::vector<double>, size_t>> results;
+            if (batched)
+            {
+                results = SearchEngine::searchBatchSoA(*datasets.soa, *datasets.batchQueries, options);
+            }
+            else
+            {
+                results.reserve(datasets.batchQueries->size());
+                for (const TimeSeries &batchQuery : *datasets.batchQueries)
+                {
+                    results.push_back(SearchEngine::searchParallelSoAOuter(*datasets.soa, batchQuery, options));
+                }
+            }
+            return results.empty() ? std::make_pair(std::vector<double>(), size_t(0)) : std::move(results.front());
+        };
+        return strategy;
+    }
+
+    // Replay del dataset in streaming: ogni serie riceve streamBatch campioni per passo
+    BenchmarkStrategy streamingStrategy()
+    {
+        BenchmarkStrategy strategy = optionalSoaStrategy("streaming", "Streaming SoA", ResultCheck::AllValues,
+                                                         [](const BenchmarkDatasets &datasets)
+                                                         { return datasets.streamFeeds != nullptr && datasets.streamBatch > 0; });
+        strategy.search = [](const BenchmarkDatasets &datasets, const TimeSeries &query, const SearchOptions &options)
+        {
+            const std::vector<std::vector<double>> &feeds = *datasets.streamFeeds;
+            size_t numSeries = feeds.size();
+            size_t batchSize = datasets.streamBatch;
+            size_t maxLength = 0;
+            for (const std::vector<double> &feed : feeds)
+            {
+                maxLength = std::max(maxLength, feed.size());
+            }
+
+            StreamingSearch stream(query, numSeries, options);
+            for (size_t position = 0; position < maxLength; position += batchSize)
+            {
+#pragma omp parallel for schedule(dynamic)
+                for (size_t i = 0; i < numSeries; ++i)
+                {
+                    if (position < feeds[i].size())
+                    {
+                        size_t count = std::min(batchSize, feeds[i].size() - position);
+                        stream.append(i, feeds[i].data() + position, count);
+                    }
+                }
+            }
+
+            if (options.stats != nullptr)
+            {
+                *options.stats += stream.getStats();
+            }
+            return stream.getResults();
+        };
+        return strategy;
+    }
+
+    // Stima sulla copia compatta: con re-rank il best match è esatto, senza
+    // tutte le distanze restano stime
+    BenchmarkStrategy compactStrategy(const std::string &name, const std::string &label, bool rerank)
+    {
+        BenchmarkStrategy strategy = optionalSoaStrategy(name, label, rerank ? ResultCheck::BestMatch : ResultCheck::BestIndex,
+                                                         [](const BenchmarkDatasets &datasets)
+                                                         { return datasets.compact != nullptr; });
+        strategy.search = [rerank](const BenchmarkDatasets &datasets, const TimeSeries &query, const SearchOptions &options)
+        {
+            return SearchEngine::searchCompactSoA(*datasets.compact, *datasets.soa, query, rerank, options);
+        };
+        return strategy;
+    }
+
+    // Ricerca esatta guidata dall'indice a blocchi: le serie scartate
+    // interamente non hanno distanza
+    BenchmarkStrategy indexedStrategy()
+    {
+        BenchmarkStrategy strategy = optionalSoaStrategy("indexed", "Indexed SoA", ResultCheck::BestMatch,
+                                                         [](const BenchmarkDatasets &datasets)
+                                                         { return datasets.index != nullptr; });
+        strategy.search = [](const BenchmarkDatasets &datasets, const TimeSeries &query, const SearchOptions &options)
+        {
+            return SearchEngine::searchIndexedSoA(*datasets.index, *datasets.soa, query, options);
+        };
+        return strategy;
+    }
+
+    BenchmarkStrategy approximateStrategy()
+    {
+        BenchmarkStrategy strategy = optionalSoaStrategy("approximate", "Approximate SoA", ResultCheck::BestIndex,
+                                                         [](const BenchmarkDatasets &datasets)
+                                                         { return datasets.approximate != nullptr; });
+        strategy.search = [](const BenchmarkDatasets &datasets, const TimeSeries &query, const SearchOptions &options)
+        {
+            return SearchEngine::searchApproximateSoA(*datasets.soa, query, *datasets.approximate, options);
+        };
+        return strategy;
+    }
+
+    // Varianti di SearchEngine, nell'ordine in cui compaiono nel JSON
+    std::vector<BenchmarkStrategy> builtinStrategies()
+    {
+        return {
+            soaStrategy("sequential", "Sequential SoA", false, SearchEngine::searchSequentialSoA),
+            aosStrategy("sequential", "Sequential AoS", false, SearchEngine::searchSequentialAoS),
+            soaStrategy("parallel_outer", "Parallel SoA Outer", true, SearchEngine::searchParallelSoAOuter),
+            soaStrategy("parallel_inner", "Parallel SoA Inner", true, SearchEngine::searchParallelSoAInner),
+            soaStrategy("parallel_collapsed", "Parallel SoA Collapsed", true, SearchEngine::searchParallelSoACollapsed),
+            soaStrategy("parallel_tasks", "Parallel SoA Tasks", true, SearchEngine::searchParallelSoATasks),
+            aosStrategy("parallel_outer", "Parallel AoS Outer", true, SearchEngine::searchParallelAoSOuter),
+            aosStrategy("parallel_inner", "Parallel AoS Inner", true, SearchEngine::searchParallelAoSInner),
+            aosStrategy("parallel_collapsed", "Parallel AoS Collapsed", true, SearchEngine::searchParallelAoSCollapsed),
+            aosStrategy("parallel_tasks", "Parallel AoS Tasks", true, SearchEngine::searchParallelAoSTasks),
+            topKStrategy(),
+            batchStrategy("batch", "Batch SoA", true),
+            batchStrategy("batch_independent", "Independent SoA", false),
+            streamingStrategy(),
+            compactStrategy("compact", "Compact SoA", true),
+            compactStrategy("compact_estimate", "Compact SoA Estimate", false),
+            indexedStrategy(),
+            approximateStrategy()};
+    }
+
+    // Glob con il solo jolly '*'
+    bool globMatch(const char *pattern, const char *text)
+    {
+        if (*pattern == '\0')
+            return *text == '\0';
+        if (*pattern == '*')
+            return globMatch(pattern + 1, text) || (*text != '\0' && globMatch(pattern, text + 1));
+        return *text == *pattern && globMatch(pattern + 1, text + 1);
+    }
+}
+
+std::vector<BenchmarkStrategy> &BenchmarkRegistry::strategies()
+{
+    static std::vector<BenchmarkStrategy> registered = builtinStrategies();
+    return registered;
+}
+
+bool BenchmarkRegistry::add(const BenchmarkStrategy &strategy)
+{
+    if (find(strategy.layout, strategy.name) != nullptr)
+    {
+        std::cerr << "Benchmark " << strategy.id() << " already registered" << std::endl;
+        return false;
+    }
+    strategies().push_back(strategy);
+    return true;
+}
+
+const std::vector<BenchmarkStrategy> &BenchmarkRegistry::all()
+{
+    return strategies();
+}
+
+const BenchmarkStrategy *BenchmarkRegistry::find(const std::string &layout, const std::string &name)
+{
+    for (const BenchmarkStrategy &strategy : strategies())
+    {
+        if (strategy.layout == layout && strategy.name == name)
+            return &strategy;
+    }
+    return nullptr;
+}
+
+bool BenchmarkRegistry::matches(const std::string &pattern, const std::string &id)
+{
+    return globMatch(pattern.c_str(), id.c_str());
+}
+
+std::vector<const BenchmarkStrategy *> BenchmarkRegistry::select(const std::string &filter)
+{
+    std::vector<std::string> includes;
+    std::vector<std::string> excludes;
+    std::stringstream stream(filter);
+    std::string pattern;
+    while (std::getline(stream, pattern, ','))
+    {
+        if (pattern.empty())
+            continue;
+        if (pattern[0] == '-')
+            excludes.push_back(pattern.substr(1));
+        else
+            includes.push_back(pattern);
+    }
+
+    std::vector<const BenchmarkStrategy *> selected;
+    for (const BenchmarkStrategy &strategy : strategies())
+    {
+        std::string id = strategy.id();
+        bool included = includes.empty();
+        for (const std::string &include : includes)
+        {
+            included = included || matches(include, id);
+        }
+        for (const std::string &exclude : excludes)
+        {
+            included = included && !matches(exclude, id);
+        }
+        if (included)
+            selected.push_back(&strategy);
+    }
+    return selected;
+}
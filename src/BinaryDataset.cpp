@@ -0,0 +1,210 @@
+#include "../include/BinaryDataset.h"
+#include "../include/MappedFile.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t BINARY_ALIGNMENT = 64;
+
+    bool validateHeader(const BinaryDatasetHeader &header, const std::string &filename)
+    {
+        if (std::memcmp(header.magic, BINARY_DATASET_MAGIC, sizeof(header.magic)) != 0)
+        {
+            std::cerr << "Errore: " << filename << " non è un dataset binario" << std::endl;
+            return false;
+        }
+        if (header.version != BINARY_DATASET_VERSION)
+        {
+            std::cerr << "Errore: versione " << header.version << " del formato binario non supportata ("
+                      << filename << ")" << std::endl;
+            return false;
+        }
+        if (header.dtype != static_cast<uint32_t>(BinaryDType::Float64))
+        {
+            std::cerr << "Errore: tipo di dato " << header.dtype << " non supportato (" << filename << ")" << std::endl;
+            return false;
+        }
+        if (header.layout > static_cast<uint32_t>(StorageLayout::Tiled) || header.alignment == 0 ||
+            header.dataOffset % header.alignment != 0)
+        {
+            std::cerr << "Errore: header non valido in " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    template <typename T>
+    bool writeStorage(const std::string &filename, const FlatStorage<T> &storage)
+    {
+        static_assert(sizeof(T) == sizeof(double), "binary format stores float64 values");
+
+        std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            std::cerr << "Errore: impossibile creare il file " << filename << std::endl;
+            return false;
+        }
+
+        size_t numSeries = storage.getNumSeries();
+        std::vector<uint64_t> lengths(numSeries);
+        std::vector<uint64_t> offsets(numSeries);
+        for (size_t i = 0; i < numSeries; ++i)
+        {
+            lengths[i] = storage.getSeriesLength(i);
+            offsets[i] = storage.getOffset(i);
+        }
+
+        BinaryDatasetHeader header = {};
+        std::memcpy(header.magic, BINARY_DATASET_MAGIC, sizeof(header.magic));
+        header.version = BINARY_DATASET_VERSION;
+        header.dtype = static_cast<uint32_t>(BinaryDType::Float64);
+        header.layout = static_cast<uint32_t>(storage.getLayout());
+        header.alignment = BINARY_ALIGNMENT;
+        header.numSeries = numSeries;
+        header.tileWidth = storage.getTileWidth();
+        header.rowCapacity = storage.getRowCapacity();
+        header.columnCapacity = storage.getColumnCapacity();
+        header.indexOffset = sizeof(BinaryDatasetHeader);
+        uint64_t indexEnd = header.indexOffset + 2 * numSeries * sizeof(uint64_t);
+        header.dataOffset = (indexEnd + BINARY_ALIGNMENT - 1) / BINARY_ALIGNMENT * BINARY_ALIGNMENT;
+        header.dataElements = storage.size();
+
+        std::vector<char> padding(header.dataOffset - indexEnd, 0);
+
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(lengths.data()), lengths.size() * sizeof(uint64_t));
+        file.write(reinterpret_cast<const char *>(offsets.data()), offsets.size() * sizeof(uint64_t));
+        file.write(padding.data(), padding.size());
+        file.write(reinterpret_cast<const char *>(storage.data()), storage.sizeInBytes());
+
+        if (!file.good())
+        {
+            std::cerr << "Errore: scrittura non riuscita su " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    template <typename T>
+    bool mapStorage(const std::string &filename, FlatStorage<T> &storage)
+    {
+        auto mapping = MappedFile::open(filename);
+        if (!mapping)
+        {
+            std::cerr << "Errore: impossibile aprire il file " << filename << std::endl;
+            return false;
+        }
+
+        size_t fileSize = mapping->size();
+        if (fileSize < sizeof(BinaryDatasetHeader))
+        {
+            std::cerr << "Errore: file binario troncato " << filename << std::endl;
+            return false;
+        }
+
+        BinaryDatasetHeader header;
+        std::memcpy(&header, mapping->bytes(), sizeof(header));
+        if (!validateHeader(header, filename))
+            return false;
+
+        StorageLayout layout = static_cast<StorageLayout>(header.layout);
+        if (layout == StorageLayout::Tiled && header.tileWidth == 0)
+        {
+            std::cerr << "Errore: header non valido in " << filename << std::endl;
+            return false;
+        }
+
+        // Campi limitati dalla dimensione del file prima di moltiplicarli
+        bool truncated = header.numSeries > fileSize / (2 * sizeof(uint64_t)) ||
+                         header.dataElements > fileSize / sizeof(T) ||
+                         header.indexOffset > fileSize || header.dataOffset > fileSize;
+        if (!truncated)
+        {
+            uint64_t indexEnd = header.indexOffset + 2 * header.numSeries * sizeof(uint64_t);
+            truncated = indexEnd > header.dataOffset || header.dataOffset + header.dataElements * sizeof(T) > fileSize;
+        }
+        if (truncated)
+        {
+            std::cerr << "Errore: file binario troncato " << filename << std::endl;
+            return false;
+        }
+
+        uint64_t stride = layout == StorageLayout::ColumnMajor ? header.columnCapacity
+                          : layout == StorageLayout::Tiled     ? header.tileWidth
+                                                               : 1;
+        std::vector<size_t> lengths(header.numSeries);
+        std::vector<size_t> offsets(header.numSeries);
+        const char *index = mapping->bytes() + header.indexOffset;
+        for (size_t i = 0; i < header.numSeries; ++i)
+        {
+            uint64_t length, offset;
+            std::memcpy(&length, index + i * sizeof(uint64_t), sizeof(uint64_t));
+            std::memcpy(&offset, index + (header.numSeries + i) * sizeof(uint64_t), sizeof(uint64_t));
+
+            // L'ultimo campione della serie deve stare nei dati
+            bool inside = length == 0 ? offset <= header.dataElements
+                                      : offset < header.dataElements &&
+                                            (length == 1 || (stride > 0 && length - 1 <= (header.dataElements - 1 - offset) / stride));
+            if (!inside)
+            {
+                std::cerr << "Errore: file binario troncato " << filename << " (serie " << i << ")" << std::endl;
+                return false;
+            }
+            lengths[i] = length;
+            offsets[i] = offset;
+        }
+
+        const T *values = reinterpret_cast<const T *>(mapping->bytes() + header.dataOffset);
+        storage = FlatStorage<T>::wrap(layout, header.tileWidth,
+                                       values, header.dataElements, std::move(offsets), std::move(lengths),
+                                       header.rowCapacity, header.columnCapacity, mapping);
+        return true;
+    }
+}
+
+bool writeBinaryDataset(const std::string &filename, const TimeSeriesSoA &dataset)
+{
+    return writeStorage(filename, dataset.getStorage());
+}
+
+bool writeBinaryDataset(const std::string &filename, const TimeSeriesAoS &dataset)
+{
+    return writeStorage(filename, dataset.getStorage());
+}
+
+bool readBinaryDatasetHeader(const std::string &filename, BinaryDatasetHeader &header)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Errore: impossibile aprire il file " << filename << std::endl;
+        return false;
+    }
+
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)))
+    {
+        std::cerr << "Errore: file binario troncato " << filename << std::endl;
+        return false;
+    }
+
+    return validateHeader(header, filename);
+}
+
+TimeSeriesSoA mapTimeSeriesSoA(const std::string &filename)
+{
+    FlatStorage<double> storage;
+    if (!mapStorage(filename, storage))
+        return TimeSeriesSoA();
+    return TimeSeriesSoA(std::move(storage));
+}
+
+TimeSeriesAoS mapTimeSeriesAoS(const std::string &filename)
+{
+    FlatStorage<Sample> storage;
+    if (!mapStorage(filename, storage))
+        return TimeSeriesAoS();
+    return TimeSeriesAoS(std::move(storage));
+}
@@ -0,0 +1,325 @@
+#include "../include/CompactDataset.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include "../include/SadKernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define COMPACT_KERNELS_X86 1
+#endif
+
+namespace
+{
+    // Offset calcolati insieme (un accumulatore per offset, loop interno vettorizzabile)
+    constexpr size_t COMPACT_BLOCK = 64;
+
+    // Errore relativo di arrotondamento del double, per i margini sulle stime
+    constexpr double DOUBLE_EPSILON = std::numeric_limits<double>::epsilon();
+
+    template <typename T>
+    size_t roundUpToLine(size_t n)
+    {
+        constexpr size_t perLine = 64 / sizeof(T);
+        return (n + perLine - 1) / perLine * perLine;
+    }
+
+    // Codifica e decodifica di un valore in un tipo compatto
+    template <typename T>
+    inline T encode(double x, double base, double scale)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            return static_cast<T>(x);
+        }
+        else
+        {
+            double level = std::round((x - base) / scale);
+            level = std::min(std::max(level, 0.0), static_cast<double>(std::numeric_limits<T>::max()));
+            return static_cast<T>(level);
+        }
+    }
+
+    template <typename T>
+    inline double decode(T value, double base, double scale)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            return static_cast<double>(value);
+        }
+        else
+        {
+            return base + value * scale;
+        }
+    }
+
+    // Float32: termini e somme in float (il margine d'errore ne tiene conto);
+    // interi: SAD esatta sui livelli in uint32
+    template <typename T>
+    using CompactAcc = std::conditional_t<std::is_floating_point_v<T>, float, uint32_t>;
+
+    template <typename T>
+    __attribute__((always_inline)) inline CompactAcc<T> absDiff(T a, T b)
+    {
+        if constexpr (std::is_floating_point_v<T>)
+        {
+            T diff = a - b;
+            return diff < T{} ? -diff : diff;
+        }
+        else
+        {
+            int diff = static_cast<int>(a) - static_cast<int>(b);
+            return static_cast<uint32_t>(diff < 0 ? -diff : diff);
+        }
+    }
+
+    // Minimo su tutti gli offset, a blocchi di COMPACT_BLOCK accumulatori
+    // (uno per offset): il loop interno scorre offset contigui ed è
+    // vettorizzato con la ISA della funzione che lo include
+    template <typename T>
+    __attribute__((always_inline)) inline CompactAcc<T> minSadBody(const T *series, const T *query,
+                                                                   size_t queryLength, size_t numOffsets)
+    {
+        alignas(64) CompactAcc<T> acc[COMPACT_BLOCK];
+        CompactAcc<T> best = std::numeric_limits<CompactAcc<T>>::max();
+
+        for (size_t j = 0; j < numOffsets; j += COMPACT_BLOCK)
+        {
+            size_t count = std::min(COMPACT_BLOCK, numOffsets - j);
+            const T *window = series + j;
+            for (size_t o = 0; o < COMPACT_BLOCK; ++o)
+            {
+                acc[o] = CompactAcc<T>();
+            }
+
+            // Anche l'ultimo blocco è pieno: gli offset oltre count leggono il
+            // padding in coda al buffer e vengono ignorati nel minimo
+            for (size_t k = 0; k < queryLength; ++k)
+            {
+                T qk = query[k];
+#pragma omp simd
+                for (size_t o = 0; o < COMPACT_BLOCK; ++o)
+                {
+                    acc[o] += absDiff(window[o + k], qk);
+                }
+            }
+
+            for (size_t o = 0; o < count; ++o)
+            {
+                best = std::min(best, acc[o]);
+            }
+        }
+
+        return best;
+    }
+
+    // Istanze per ISA, come in DistanceKernels.cpp; gli interi a 512 bit
+    // richiedono AVX-512BW oltre ad AVX-512F
+    struct BaselineIsa
+    {
+        template <typename T>
+        static CompactAcc<T> minSad(const T *series, const T *query, size_t queryLength, size_t numOffsets)
+        {
+            return minSadBody(series, query, queryLength, numOffsets);
+        }
+    };
+
+#ifdef COMPACT_KERNELS_X86
+    struct AVX2Isa
+    {
+        template <typename T>
+        __attribute__((target("avx2"))) static CompactAcc<T> minSad(const T *series, const T *query,
+                                                                    size_t queryLength, size_t numOffsets)
+        {
+            return minSadBody(series, query, queryLength, numOffsets);
+        }
+    };
+
+    struct AVX512Isa
+    {
+        template <typename T>
+        __attribute__((target("avx512f,avx512bw"))) static CompactAcc<T> minSad(const T *series, const T *query,
+                                                                                size_t queryLength, size_t numOffsets)
+        {
+            return minSadBody(series, query, queryLength, numOffsets);
+        }
+    };
+#endif
+
+    template <typename T>
+    using MinSadFn = CompactAcc<T> (*)(const T *, const T *, size_t, size_t);
+
+    // Kernel per la ISA attiva dei kernel SAD (SadKernels::setActive)
+    template <typename T>
+    MinSadFn<T> selectMinSad()
+    {
+#ifdef COMPACT_KERNELS_X86
+        switch (SadKernels::active().isa)
+        {
+        case SimdIsa::AVX512:
+            if (__builtin_cpu_supports("avx512bw"))
+                return &AVX512Isa::minSad<T>;
+            return &AVX2Isa::minSad<T>;
+        case SimdIsa::AVX2:
+            return &AVX2Isa::minSad<T>;
+        default:
+            break;
+        }
+#endif
+        return &BaselineIsa::minSad<T>;
+    }
+}
+
+CompactDataset CompactDataset::build(const TimeSeriesSoA &dataset, ElementType type)
+{
+    CompactDataset compact;
+    compact.type = type;
+
+    switch (type)
+    {
+    case ElementType::Float32:
+        compact.buildSeries(dataset, compact.floats, 0.0);
+        break;
+    case ElementType::Int16:
+        compact.buildSeries(dataset, compact.words, std::numeric_limits<uint16_t>::max());
+        break;
+    case ElementType::Int8:
+        compact.buildSeries(dataset, compact.bytes, std::numeric_limits<uint8_t>::max());
+        break;
+    case ElementType::Float64:
+        break;
+    }
+
+    return compact;
+}
+
+size_t CompactDataset::sizeInBytes() const
+{
+    return floats.size() * sizeof(float) + words.size() * sizeof(uint16_t) + bytes.size() * sizeof(uint8_t);
+}
+
+size_t CompactDataset::maxQueryLength(ElementType type)
+{
+    // Limite dell'accumulatore uint32: queryLength * livello massimo
+    switch (type)
+    {
+    case ElementType::Int16:
+        return std::numeric_limits<uint32_t>::max() / std::numeric_limits<uint16_t>::max();
+    case ElementType::Int8:
+        return std::numeric_limits<uint32_t>::max() / std::numeric_limits<uint8_t>::max();
+    default:
+        return std::numeric_limits<size_t>::max();
+    }
+}
+
+template <typename T>
+void CompactDataset::buildSeries(const TimeSeriesSoA &dataset, AlignedVector<T> &values, double levels)
+{
+    size_t numSeries = dataset.getNumSeries();
+    lengths.resize(numSeries);
+    offsets.resize(numSeries);
+    base.assign(numSeries, 0.0);
+    scale.assign(numSeries, 1.0);
+    sampleError.assign(numSeries, 0.0);
+
+    size_t total = 0;
+    for (size_t i = 0; i < numSeries; ++i)
+    {
+        lengths[i] = dataset.getSeriesLength(i);
+        offsets[i] = total;
+        total += roundUpToLine<T>(lengths[i]);
+    }
+    values.assign(total + COMPACT_BLOCK, T());
+
+#pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < numSeries; ++i)
+    {
+        auto series = dataset.getSeries(i);
+        if (series.empty())
+            continue;
+
+        if (levels > 0.0)
+        {
+            double minValue = series[0];
+            double maxValue = series[0];
+            for (size_t t = 1; t < series.size(); ++t)
+            {
+                minValue = std::min(minValue, series[t]);
+                maxValue = std::max(maxValue, series[t]);
+            }
+            base[i] = minValue;
+            scale[i] = maxValue > minValue ? (maxValue - minValue) / levels : 1.0;
+        }
+
+        // Errore di rappresentazione misurato sui valori effettivi
+        T *dst = values.data() + offsets[i];
+        double maxError = 0.0;
+        for (size_t t = 0; t < series.size(); ++t)
+        {
+            dst[t] = encode<T>(series[t], base[i], scale[i]);
+            maxError = std::max(maxError, std::abs(series[t] - decode(dst[t], base[i], scale[i])));
+        }
+        sampleError[i] = maxError;
+    }
+}
+
+template <typename T>
+CompactEstimate CompactDataset::estimate(const AlignedVector<T> &values, size_t seriesIndex, const double *query,
+                                         size_t queryLength, AlignedVector<T> &quantizedQuery) const
+{
+    size_t length = lengths[seriesIndex];
+    if (length < queryLength || queryLength == 0)
+        return {std::numeric_limits<double>::max(), 0.0};
+
+    // Query nella rappresentazione della serie. Un valore q fuori da [lo, hi]
+    // viene saturato a c: poiché ogni campione decodificato x' sta in [lo, hi],
+    // |x' - q| = |x' - c| + |c - q| e la distanza di saturazione si somma
+    // esattamente alla stima; nel limite entra solo l'arrotondamento di c
+    double seriesBase = base[seriesIndex];
+    double seriesScale = scale[seriesIndex];
+    double lo = decode(std::numeric_limits<T>::lowest(), seriesBase, seriesScale);
+    double hi = decode(std::numeric_limits<T>::max(), seriesBase, seriesScale);
+    quantizedQuery.resize(queryLength);
+    double saturation = 0.0;
+    double queryError = 0.0;
+    for (size_t k = 0; k < queryLength; ++k)
+    {
+        double clamped = query[k];
+        if constexpr (!std::is_floating_point_v<T>)
+        {
+            clamped = std::min(std::max(clamped, lo), hi);
+            saturation += std::abs(query[k] - clamped);
+        }
+        quantizedQuery[k] = encode<T>(clamped, seriesBase, seriesScale);
+        queryError += std::abs(clamped - decode(quantizedQuery[k], seriesBase, seriesScale));
+    }
+
+    const T *series = values.data() + offsets[seriesIndex];
+    size_t numOffsets = length - queryLength + 1;
+    CompactAcc<T> best = selectMinSad<T>()(series, quantizedQuery.data(), queryLength, numOffsets);
+
+    // |SAD esatta - SAD stimata| <= somma degli errori su serie e query per
+    // termine, più un margine per gli arrotondamenti del double
+    double minSad = static_cast<double>(best) * (std::is_floating_point_v<T> ? 1.0 : seriesScale) + saturation;
+    double error = queryLength * sampleError[seriesIndex] + queryError;
+    double rounding = std::is_floating_point_v<T> ? std::numeric_limits<float>::epsilon() : DOUBLE_EPSILON;
+    error += (queryLength + 2) * rounding * (minSad + error);
+    return {minSad, error};
+}
+
+CompactEstimate CompactDataset::approximateMinSad(size_t seriesIndex, const double *query, size_t queryLength,
+                                                  CompactScratch &scratch) const
+{
+    switch (type)
+    {
+    case ElementType::Float32:
+        return estimate(floats, seriesIndex, query, queryLength, scratch.floatQuery);
+    case ElementType::Int16:
+        return estimate(words, seriesIndex, query, queryLength, scratch.wordQuery);
+    case ElementType::Int8:
+        return estimate(bytes, seriesIndex, query, queryLength, scratch.byteQuery);
+    case ElementType::Float64:
+        break;
+    }
+    return {std::numeric_limits<double>::max(), std::numeric_limits<double>::max()};
+}
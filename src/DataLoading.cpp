@@ -1,82 +1,222 @@
 #include "../include/DataLoading.h"
+#include "../include/MappedFile.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <omp.h>
 
-// Importa la timeseries dal csv (AoS)
-std::vector<TimeSeries> loadTimeSeriesAoS(const std::string &filename) {
-    std::vector<TimeSeries> timeSeriesList;
-    std::ifstream file(filename);
-    std::string line;
-    
-    if (!file.is_open()) {
-        std::cerr << "Errore: impossibile aprire il file " << filename << std::endl;
-        return timeSeriesList;
+namespace {
+    // Dimensione minima di un blocco: sotto questa soglia i thread non convengono
+    constexpr size_t MIN_CHUNK_BYTES = 64 * 1024;
+
+    // Blocchi per thread, per bilanciare righe di lunghezza diversa
+    constexpr int CHUNKS_PER_THREAD = 4;
+
+    // Blocco di righe intere del file e lunghezze delle serie che contiene
+    struct CsvChunk {
+        const char *begin;
+        const char *end;
+        std::vector<size_t> lengths;
+        size_t firstSeries = 0;
+    };
+
+    inline bool isBlank(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    inline const char *lineEnd(const char *begin, const char *end) {
+        const char *newline = static_cast<const char *>(std::memchr(begin, '\n', end - begin));
+        return newline != nullptr ? newline : end;
     }
-    
-    while (std::getline(file, line)) {
-        std::vector<double> values;
-        std::stringstream ss(line);
-        std::string value;
-        
-        while (std::getline(ss, value, ',')) {
-            values.push_back(std::stod(value));
+
+    // Numero di valori della riga [begin, end); una virgola finale non conta
+    // come campo vuoto (come con std::getline)
+    size_t countFields(const char *begin, const char *end) {
+        while (begin < end && isBlank(*begin)) ++begin;
+        while (end > begin && isBlank(end[-1])) --end;
+        if (begin == end) {
+            return 0;
         }
-        
-        if (!values.empty()) {
-            timeSeriesList.push_back(TimeSeries(values));
+
+        size_t fields = 1 + std::count(begin, end, ',');
+        if (end[-1] == ',') {
+            --fields;
         }
+        return fields;
     }
-    
-    file.close();
-    return timeSeriesList;
-}
 
-// Importa la timeseries dal csv (SoA)
-TimeSeriesSoA loadTimeSeriesSoA(const std::string &filename) {
-    TimeSeriesSoA dataset;
-    std::ifstream file(filename);
-    std::string line;
-    
-    if (!file.is_open()) {
-        std::cerr << "Errore: impossibile aprire il file " << filename << std::endl;
-        return dataset;
+    // Scrive i count valori della riga in out a passo stride; false se un valore non è valido
+    template <typename T>
+    bool parseLine(const char *p, const char *end, T *out, size_t stride, size_t count) {
+        for (size_t field = 0; field < count; ++field) {
+            while (p < end && isBlank(*p)) ++p;
+            if (p < end && *p == '+') ++p;
+
+            double value;
+            auto [next, error] = std::from_chars(p, end, value);
+            if (error != std::errc()) {
+                return false;
+            }
+            out[field * stride] = value;
+
+            p = next;
+            while (p < end && isBlank(*p)) ++p;
+            if (p < end && *p == ',') {
+                ++p;
+            } else if (field + 1 < count) {
+                return false;
+            }
+        }
+
+        while (p < end && isBlank(*p)) ++p;
+        return p == end;
     }
-    
-    while (std::getline(file, line)) {
-        std::vector<double> values;
-        std::stringstream ss(line);
-        std::string value;
-        
-        while (std::getline(ss, value, ',')) {
-            values.push_back(std::stod(value));
+
+    // Caricamento in due passate parallele sui blocchi: conteggio dei valori
+    // per riga (per dimensionare lo storage) e parsing nella posizione finale
+    template <typename T>
+    bool parseCsv(const std::string &filename, FlatStorage<T> &storage, CsvLoadStats *stats) {
+        auto start = std::chrono::high_resolution_clock::now();
+
+        auto file = MappedFile::open(filename);
+        if (!file) {
+            std::cerr << "Errore: impossibile aprire il file " << filename << std::endl;
+            return false;
+        }
+
+        const char *data = file->bytes();
+        size_t size = file->size();
+
+        size_t numChunks = 0;
+        if (size > 0) {
+            numChunks = static_cast<size_t>(omp_get_max_threads()) * CHUNKS_PER_THREAD;
+            numChunks = std::max<size_t>(1, std::min(numChunks, size / MIN_CHUNK_BYTES));
+        }
+
+        // Ogni blocco inizia alla prima riga che comincia dopo la sua posizione nominale
+        std::vector<CsvChunk> chunks(numChunks);
+        for (size_t c = 0; c < numChunks; ++c) {
+            size_t position = c * size / numChunks;
+            const char *begin = data + position;
+            if (position > 0 && data[position - 1] != '\n') {
+                begin = lineEnd(begin, data + size);
+                begin = begin < data + size ? begin + 1 : begin;
+            }
+            chunks[c].begin = begin;
         }
-        
-        if (!values.empty()) {
-            dataset.addSeries(values);
+        for (size_t c = 0; c < numChunks; ++c) {
+            chunks[c].end = c + 1 < numChunks ? chunks[c + 1].begin : data + size;
         }
+
+#pragma omp parallel for schedule(dynamic)
+        for (size_t c = 0; c < numChunks; ++c) {
+            CsvChunk &chunk = chunks[c];
+            for (const char *p = chunk.begin; p < chunk.end;) {
+                const char *end = lineEnd(p, chunk.end);
+                size_t fields = countFields(p, end);
+                if (fields > 0) {
+                    chunk.lengths.push_back(fields);
+                }
+                p = end + 1;
+            }
+        }
+
+        std::vector<size_t> lengths;
+        for (CsvChunk &chunk : chunks) {
+            chunk.firstSeries = lengths.size();
+            lengths.insert(lengths.end(), chunk.lengths.begin(), chunk.lengths.end());
+        }
+
+        storage.allocate(lengths);
+        size_t stride = storage.getStride();
+        size_t failures = 0;
+
+#pragma omp parallel for schedule(dynamic) reduction(+ : failures)
+        for (size_t c = 0; c < numChunks; ++c) {
+            const CsvChunk &chunk = chunks[c];
+            size_t series = chunk.firstSeries;
+            for (const char *p = chunk.begin; p < chunk.end;) {
+                const char *end = lineEnd(p, chunk.end);
+                size_t fields = countFields(p, end);
+                if (fields > 0) {
+                    if (!parseLine(p, end, storage.getMutableSeriesData(series), stride, fields)) {
+                        failures++;
+                    }
+                    series++;
+                }
+                p = end + 1;
+            }
+        }
+
+        if (failures > 0) {
+            std::cerr << "Errore: " << failures << " righe con valori non validi in " << filename << std::endl;
+            storage.allocate({});
+            return false;
+        }
+
+        if (stats != nullptr) {
+            stats->bytes = size;
+            stats->numSeries = lengths.size();
+            stats->seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        }
+        return true;
     }
-    
-    file.close();
-    return dataset;
 }
 
+// Importa la timeseries dal csv (AoS)
+std::vector<TimeSeries> loadTimeSeriesAoS(const std::string &filename, CsvLoadStats *stats) {
+    std::vector<TimeSeries> timeSeriesList;
+    FlatStorage<double> storage(StorageLayout::RowMajor);
+
+    if (!parseCsv(filename, storage, stats)) {
+        return timeSeriesList;
+    }
+
+    timeSeriesList.reserve(storage.getNumSeries());
+    for (size_t i = 0; i < storage.getNumSeries(); ++i) {
+        const double *values = storage.getSeriesData(i);
+        timeSeriesList.push_back(TimeSeries(std::vector<double>(values, values + storage.getSeriesLength(i))));
+    }
+
+    return timeSeriesList;
+}
+
+// Importa la timeseries dal csv direttamente nello storage AoS
+TimeSeriesAoS loadTimeSeriesAoSDataset(const std::string &filename, StorageLayout layout, CsvLoadStats *stats) {
+    FlatStorage<Sample> storage(layout);
+    parseCsv(filename, storage, stats);
+    return TimeSeriesAoS(std::move(storage));
+}
+
+// Importa la timeseries dal csv (SoA)
+TimeSeriesSoA loadTimeSeriesSoA(const std::string &filename, StorageLayout layout, CsvLoadStats *stats) {
+    FlatStorage<double> storage(layout);
+    parseCsv(filename, storage, stats);
+    return TimeSeriesSoA(std::move(storage));
+}
+
+// Prima riga del file, con le stesse regole di parsing del dataset
 TimeSeries loadQueryFromCSV(const std::string &filename) {
     std::ifstream file(filename);
     std::string line;
     std::vector<double> values;
-    
+
     if (!file.is_open()) {
         std::cerr << "Errore: impossibile aprire il file " << filename << std::endl;
         return TimeSeries(values);
     }
-    
+
     if (std::getline(file, line)) {
-        std::stringstream ss(line);
-        std::string value;
-        
-        while (std::getline(ss, value, ',')) {
-            values.push_back(std::stod(value));
+        const char *begin = line.data();
+        const char *end = begin + line.size();
+        values.resize(countFields(begin, end));
+        if (!parseLine(begin, end, values.data(), 1, values.size())) {
+            std::cerr << "Errore: valori non validi nella query " << filename << std::endl;
+            values.clear();
         }
     }
-    
+
     file.close();
     return TimeSeries(values);
-}
\ No newline at end of file
+}
@@ -0,0 +1,171 @@
+#include "../include/DatasetBuilder.h"
+#include "../include/BinaryDataset.h"
+#include "../include/DataLoading.h"
+#include "../include/MemoryUsage.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+namespace
+{
+    // Blocco della trasposizione: RELAYOUT_SERIES_BLOCK serie x RELAYOUT_TIME_BLOCK
+    // istanti (32 KiB di double), così sorgente e destinazione restano in L1/L2
+    constexpr size_t RELAYOUT_SERIES_BLOCK = 64;
+    constexpr size_t RELAYOUT_TIME_BLOCK = 64;
+
+    template <typename Dst, typename Src>
+    FlatStorage<Dst> relayout(const FlatStorage<Src> &source, StorageLayout layout)
+    {
+        size_t numSeries = source.getNumSeries();
+        std::vector<size_t> lengths(numSeries);
+        for (size_t i = 0; i < numSeries; ++i)
+        {
+            lengths[i] = source.getSeriesLength(i);
+        }
+
+        FlatStorage<Dst> target(layout);
+        target.allocate(lengths);
+
+        size_t sourceStride = source.getStride();
+        size_t targetStride = target.getStride();
+        size_t seriesBlocks = (numSeries + RELAYOUT_SERIES_BLOCK - 1) / RELAYOUT_SERIES_BLOCK;
+        size_t timeBlocks = (source.getMaxLength() + RELAYOUT_TIME_BLOCK - 1) / RELAYOUT_TIME_BLOCK;
+
+#pragma omp parallel for collapse(2) schedule(static)
+        for (size_t sb = 0; sb < seriesBlocks; ++sb)
+        {
+            for (size_t tb = 0; tb < timeBlocks; ++tb)
+            {
+                size_t seriesEnd = std::min(numSeries, (sb + 1) * RELAYOUT_SERIES_BLOCK);
+                size_t timeBegin = tb * RELAYOUT_TIME_BLOCK;
+
+                for (size_t i = sb * RELAYOUT_SERIES_BLOCK; i < seriesEnd; ++i)
+                {
+                    size_t timeEnd = std::min(lengths[i], timeBegin + RELAYOUT_TIME_BLOCK);
+                    const Src *src = source.getSeriesData(i);
+                    Dst *dst = target.getMutableSeriesData(i);
+
+                    for (size_t t = timeBegin; t < timeEnd; ++t)
+                    {
+                        dst[t * targetStride] = static_cast<double>(src[t * sourceStride]);
+                    }
+                }
+            }
+        }
+
+        return target;
+    }
+
+    bool binaryCacheIsFresh(const std::string &binaryPath, const std::string &csvPath)
+    {
+        std::error_code error;
+        if (!std::filesystem::exists(binaryPath, error))
+            return false;
+        return std::filesystem::last_write_time(binaryPath, error) >= std::filesystem::last_write_time(csvPath, error);
+    }
+
+    // Esegue una fase registrandone tempo e memoria residente
+    template <typename Phase>
+    void runPhase(const std::string &name, DatasetBuildReport *report, Phase phase)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        phase();
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        if (report != nullptr)
+        {
+            report->phases.push_back({name, elapsed, MemoryUsage::currentRssBytes(), MemoryUsage::peakRssBytes()});
+        }
+    }
+}
+
+std::string DatasetBuilder::binaryCachePath(const std::string &csvPath, StorageLayout layout)
+{
+    std::string prefix = csvPath.size() > 4 && csvPath.compare(csvPath.size() - 4, 4, ".csv") == 0
+                             ? csvPath.substr(0, csvPath.size() - 4)
+                             : csvPath;
+    return prefix + "." + storageLayoutName(layout) + ".bin";
+}
+
+TimeSeriesAoS DatasetBuilder::toAoS(const TimeSeriesSoA &dataset, StorageLayout layout)
+{
+    return TimeSeriesAoS(relayout<Sample>(dataset.getStorage(), layout));
+}
+
+TimeSeriesSoA DatasetBuilder::toSoA(const TimeSeriesAoS &dataset, StorageLayout layout)
+{
+    return TimeSeriesSoA(relayout<double>(dataset.getStorage(), layout));
+}
+
+bool DatasetBuilder::build(const std::string &csvPath,
+                           StorageLayout soaLayout,
+                           StorageLayout aosLayout,
+                           bool useBinaryCache,
+                           TimeSeriesSoA &soa,
+                           TimeSeriesAoS &aos,
+                           DatasetBuildReport *report)
+{
+    std::string soaBinary = binaryCachePath(csvPath, soaLayout);
+    std::string aosBinary = binaryCachePath(csvPath, aosLayout);
+    std::string soaSource;
+    std::string aosSource;
+
+    soa = TimeSeriesSoA(soaLayout);
+    aos = TimeSeriesAoS(aosLayout);
+
+    if (useBinaryCache && binaryCacheIsFresh(soaBinary, csvPath))
+    {
+        runPhase("map_soa", report, [&] { soa = mapTimeSeriesSoA(soaBinary); });
+        soaSource = soa.getNumSeries() > 0 ? "binary" : "";
+    }
+    if (useBinaryCache && binaryCacheIsFresh(aosBinary, csvPath))
+    {
+        runPhase("map_aos", report, [&] { aos = mapTimeSeriesAoS(aosBinary); });
+        aosSource = aos.getNumSeries() > 0 ? "binary" : "";
+    }
+
+    // Un solo parsing del CSV, nel layout SoA; l'AoS deriva da questo
+    if (soaSource.empty() && aosSource.empty())
+    {
+        CsvLoadStats stats;
+        runPhase("parse_csv", report, [&] { soa = loadTimeSeriesSoA(csvPath, soaLayout, &stats); });
+        if (soa.getNumSeries() == 0)
+            return false;
+
+        soaSource = "csv";
+        if (report != nullptr)
+        {
+            report->csv_mb_per_s = stats.megabytesPerSecond();
+        }
+    }
+
+    if (soaSource.empty())
+    {
+        runPhase("relayout_soa", report, [&] { soa = toSoA(aos, soaLayout); });
+        soaSource = "relayout";
+    }
+    if (aosSource.empty())
+    {
+        runPhase("relayout_aos", report, [&] { aos = toAoS(soa, aosLayout); });
+        aosSource = "relayout";
+    }
+
+    if (useBinaryCache && (soaSource != "binary" || aosSource != "binary"))
+    {
+        runPhase("write_cache", report, [&]
+                 {
+                     if (soaSource != "binary")
+                         writeBinaryDataset(soaBinary, soa);
+                     if (aosSource != "binary" && aosBinary != soaBinary)
+                         writeBinaryDataset(aosBinary, aos);
+                 });
+    }
+
+    if (report != nullptr)
+    {
+        report->soa_source = soaSource;
+        report->aos_source = aosSource;
+    }
+
+    return soa.getNumSeries() > 0 && aos.getNumSeries() > 0;
+}
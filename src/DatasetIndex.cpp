@@ -0,0 +1,244 @@
+#include "../include/DatasetIndex.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+    // Distanza di q dall'intervallo [lo, hi] (0 se q è dentro)
+    inline double envelopeDistance(double q, double lo, double hi)
+    {
+        return std::max(lo - q, 0.0) + std::max(q - hi, 0.0);
+    }
+}
+
+template <typename Dataset>
+DatasetIndex DatasetIndex::buildIndex(const Dataset &dataset, size_t blockLength)
+{
+    DatasetIndex index;
+    if (blockLength == 0)
+        return index;
+
+    index.blockLength = blockLength;
+    index.lengths.resize(dataset.getNumSeries());
+    for (size_t i = 0; i < index.lengths.size(); ++i)
+    {
+        index.lengths[i] = dataset.getSeriesLength(i);
+    }
+    index.assignBlocks();
+
+#pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < index.lengths.size(); ++i)
+    {
+        auto series = dataset.getSeries(i);
+        for (size_t b = 0; b < index.getNumBlocks(i); ++b)
+        {
+            size_t begin = b * blockLength;
+            size_t end = std::min(begin + blockLength, series.size());
+            double minValue = series[begin];
+            double maxValue = series[begin];
+            for (size_t t = begin + 1; t < end; ++t)
+            {
+                minValue = std::min(minValue, static_cast<double>(series[t]));
+                maxValue = std::max(maxValue, static_cast<double>(series[t]));
+            }
+            index.blockMin[index.firstBlock[i] + b] = minValue;
+            index.blockMax[index.firstBlock[i] + b] = maxValue;
+        }
+    }
+
+    return index;
+}
+
+void DatasetIndex::assignBlocks()
+{
+    firstBlock.assign(lengths.size() + 1, 0);
+    for (size_t i = 0; i < lengths.size(); ++i)
+    {
+        firstBlock[i + 1] = firstBlock[i] + (lengths[i] + blockLength - 1) / blockLength;
+    }
+    blockMin.assign(firstBlock.back(), 0.0);
+    blockMax.assign(firstBlock.back(), 0.0);
+}
+
+DatasetIndex DatasetIndex::build(const TimeSeriesSoA &dataset, size_t blockLength)
+{
+    return buildIndex(dataset, blockLength);
+}
+
+DatasetIndex DatasetIndex::build(const TimeSeriesAoS &dataset, size_t blockLength)
+{
+    return buildIndex(dataset, blockLength);
+}
+
+bool DatasetIndex::save(const std::string &filename) const
+{
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        std::cerr << "Errore: impossibile creare il file " << filename << std::endl;
+        return false;
+    }
+
+    DatasetIndexHeader header = {};
+    std::memcpy(header.magic, DATASET_INDEX_MAGIC, sizeof(header.magic));
+    header.version = DATASET_INDEX_VERSION;
+    header.blockLength = blockLength;
+    header.numSeries = lengths.size();
+    header.numBlocks = blockMin.size();
+
+    std::vector<uint64_t> seriesLengths(lengths.begin(), lengths.end());
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(seriesLengths.data()), seriesLengths.size() * sizeof(uint64_t));
+    file.write(reinterpret_cast<const char *>(blockMin.data()), blockMin.size() * sizeof(double));
+    file.write(reinterpret_cast<const char *>(blockMax.data()), blockMax.size() * sizeof(double));
+
+    if (!file.good())
+    {
+        std::cerr << "Errore: scrittura non riuscita su " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+DatasetIndex DatasetIndex::load(const std::string &filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        std::cerr << "Errore: impossibile aprire il file " << filename << std::endl;
+        return DatasetIndex();
+    }
+
+    DatasetIndexHeader header;
+    if (!file.read(reinterpret_cast<char *>(&header), sizeof(header)))
+    {
+        std::cerr << "Errore: indice troncato " << filename << std::endl;
+        return DatasetIndex();
+    }
+    if (std::memcmp(header.magic, DATASET_INDEX_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != DATASET_INDEX_VERSION || header.blockLength == 0)
+    {
+        std::cerr << "Errore: " << filename << " non è un indice valido" << std::endl;
+        return DatasetIndex();
+    }
+
+    // Lunghezze e blocchi devono occupare esattamente il resto del file:
+    // verificato prima di allocare in base all'header
+    std::error_code error;
+    uint64_t payload = std::filesystem::file_size(filename, error) - sizeof(header);
+    if (error || header.numSeries > payload / sizeof(uint64_t) ||
+        header.numBlocks > (payload - header.numSeries * sizeof(uint64_t)) / (2 * sizeof(double)) ||
+        header.numSeries * sizeof(uint64_t) + header.numBlocks * 2 * sizeof(double) != payload)
+    {
+        std::cerr << "Errore: indice troncato " << filename << std::endl;
+        return DatasetIndex();
+    }
+
+    DatasetIndex index;
+    index.blockLength = header.blockLength;
+    std::vector<uint64_t> seriesLengths(header.numSeries);
+    if (!file.read(reinterpret_cast<char *>(seriesLengths.data()), seriesLengths.size() * sizeof(uint64_t)))
+    {
+        std::cerr << "Errore: indice troncato " << filename << std::endl;
+        return DatasetIndex();
+    }
+
+    // Le lunghezze devono descrivere proprio numBlocks blocchi
+    uint64_t numBlocks = 0;
+    for (uint64_t length : seriesLengths)
+    {
+        numBlocks += length / header.blockLength + (length % header.blockLength != 0);
+        if (numBlocks > header.numBlocks)
+            break;
+    }
+    if (numBlocks != header.numBlocks)
+    {
+        std::cerr << "Errore: " << filename << " non è un indice valido" << std::endl;
+        return DatasetIndex();
+    }
+    index.lengths.assign(seriesLengths.begin(), seriesLengths.end());
+    index.assignBlocks();
+
+    if (index.blockMin.size() != header.numBlocks ||
+        !file.read(reinterpret_cast<char *>(index.blockMin.data()), index.blockMin.size() * sizeof(double)) ||
+        !file.read(reinterpret_cast<char *>(index.blockMax.data()), index.blockMax.size() * sizeof(double)))
+    {
+        std::cerr << "Errore: indice troncato " << filename << std::endl;
+        return DatasetIndex();
+    }
+
+    return index;
+}
+
+std::string DatasetIndex::indexPath(const std::string &csvPath, size_t blockLength)
+{
+    std::string prefix = csvPath.size() > 4 && csvPath.compare(csvPath.size() - 4, 4, ".csv") == 0
+                             ? csvPath.substr(0, csvPath.size() - 4)
+                             : csvPath;
+    return prefix + ".block" + std::to_string(blockLength) + ".idx";
+}
+
+template <typename Dataset>
+bool DatasetIndex::matchesDataset(const Dataset &dataset) const
+{
+    if (empty() || dataset.getNumSeries() != lengths.size())
+        return false;
+
+    for (size_t i = 0; i < lengths.size(); ++i)
+    {
+        if (dataset.getSeriesLength(i) != lengths[i])
+            return false;
+    }
+    return true;
+}
+
+bool DatasetIndex::matches(const TimeSeriesSoA &dataset) const
+{
+    return matchesDataset(dataset);
+}
+
+bool DatasetIndex::matches(const TimeSeriesAoS &dataset) const
+{
+    return matchesDataset(dataset);
+}
+
+size_t DatasetIndex::sizeInBytes() const
+{
+    return sizeof(DatasetIndexHeader) + lengths.size() * sizeof(uint64_t) +
+           (blockMin.size() + blockMax.size()) * sizeof(double);
+}
+
+double DatasetIndex::blockBound(size_t seriesIndex, size_t block, const double *query, size_t queryLength) const
+{
+    const double *minValues = blockMin.data() + firstBlock[seriesIndex];
+    const double *maxValues = blockMax.data() + firstBlock[seriesIndex];
+    size_t numBlocks = getNumBlocks(seriesIndex);
+    double bound = 0.0;
+
+    // Tratti di blockLength posizioni della query: la prima posizione di ogni
+    // tratto legge solo il blocco j, le altre anche il blocco j + 1 (se esiste)
+    for (size_t begin = 0; begin < queryLength; begin += blockLength)
+    {
+        size_t j = block + begin / blockLength;
+        size_t end = std::min(begin + blockLength, queryLength);
+        double lo = minValues[j];
+        double hi = maxValues[j];
+        bound += envelopeDistance(query[begin], lo, hi);
+
+        if (j + 1 < numBlocks)
+        {
+            lo = std::min(lo, minValues[j + 1]);
+            hi = std::max(hi, maxValues[j + 1]);
+        }
+        for (size_t k = begin + 1; k < end; ++k)
+        {
+            bound += envelopeDistance(query[k], lo, hi);
+        }
+    }
+
+    return bound;
+}
@@ -0,0 +1,399 @@
+#include "../include/SadKernels.h"
+#include "../include/DistanceMetrics.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define DISTANCE_KERNELS_X86 1
+#endif
+
+// Kernel generici per metrica: il corpo è scritto una volta come template
+// sulla policy (DistanceMetrics.h) e istanziato per ogni ISA con l'attributo
+// target, su vettori (vector_size) larghi quanto un registro della ISA.
+// Come per la SAD ogni lane accumula i termini in ordine di k e il file è
+// compilato con -ffp-contract=off, quindi i risultati sono identici bit a bit
+// tra le ISA. Per sad, squared_euclidean e chebyshev lo sono anche tra le
+// varianti di ricerca; per znorm_euclidean le statistiche scorrevoli
+// ripartono a ogni tratto di serie, quindi varianti che la dividono in modo
+// diverso coincidono a meno di arrotondamenti. La SAD usa i kernel scritti a
+// mano di SadKernels.cpp.
+namespace
+{
+    // Vettori della larghezza di un registro di ciascuna ISA
+    using Vec128 = double __attribute__((vector_size(16)));
+    using Vec256 = double __attribute__((vector_size(32)));
+    using Vec512 = double __attribute__((vector_size(64)));
+
+    // Offset per blocco: statistiche delle finestre e distanze restano nello stack
+    constexpr size_t STATS_CHUNK = 256;
+
+    // Early abandoning, come in SadKernels.cpp
+    constexpr size_t ABANDON_GROUP = 16;
+    constexpr size_t ABANDON_BLOCK = 16;
+
+    // Vettori solo per riferimento (vedi DistanceMetrics.h)
+    template <typename Vec>
+    __attribute__((always_inline)) inline void loadVec(Vec &value, const double *data)
+    {
+        std::memcpy(&value, data, sizeof(Vec));
+    }
+
+    template <typename Vec>
+    __attribute__((always_inline)) inline void storeVec(double *data, const Vec &value)
+    {
+        std::memcpy(data, &value, sizeof(Vec));
+    }
+
+    // Metric::accumulate(acc[j], norm_j(series[j + k]), query[k]) per k crescente,
+    // 2 vettori di offset alla volta tenuti nei registri per tutto il loop su k
+    template <typename Metric, typename Vec>
+    __attribute__((always_inline)) inline void accumulateBody(const double *series, const double *query,
+                                                              size_t queryLength, size_t numOffsets,
+                                                              const double *mean, const double *invStd,
+                                                              double *acc)
+    {
+        constexpr size_t VEC_LANES = sizeof(Vec) / sizeof(double);
+        constexpr size_t LANES = 2 * VEC_LANES;
+
+        size_t j = 0;
+        for (; j + LANES <= numOffsets; j += LANES)
+        {
+            Vec sumLow, sumHigh;
+            loadVec(sumLow, acc + j);
+            loadVec(sumHigh, acc + j + VEC_LANES);
+            Vec muLow{}, muHigh{}, scaleLow{}, scaleHigh{};
+            if constexpr (Metric::normalized)
+            {
+                loadVec(muLow, mean + j);
+                loadVec(muHigh, mean + j + VEC_LANES);
+                loadVec(scaleLow, invStd + j);
+                loadVec(scaleHigh, invStd + j + VEC_LANES);
+            }
+
+            for (size_t k = 0; k < queryLength; ++k)
+            {
+                Vec q = Vec{} + query[k];
+                Vec low, high;
+                loadVec(low, series + j + k);
+                loadVec(high, series + j + k + VEC_LANES);
+                if constexpr (Metric::normalized)
+                {
+                    low = (low - muLow) * scaleLow;
+                    high = (high - muHigh) * scaleHigh;
+                }
+                Metric::accumulate(sumLow, low, q);
+                Metric::accumulate(sumHigh, high, q);
+            }
+
+            storeVec(acc + j, sumLow);
+            storeVec(acc + j + VEC_LANES, sumHigh);
+        }
+
+        for (; j < numOffsets; ++j)
+        {
+            double sum = acc[j];
+            for (size_t k = 0; k < queryLength; ++k)
+            {
+                double value = series[j + k];
+                if constexpr (Metric::normalized)
+                {
+                    value = (value - mean[j]) * invStd[j];
+                }
+                Metric::accumulate(sum, value, query[k]);
+            }
+            acc[j] = sum;
+        }
+    }
+
+    inline void setWindowStats(double sum, double sumSquares, size_t queryLength, double &mean, double &invStd)
+    {
+        double mu = sum / queryLength;
+        double variance = sumSquares / queryLength - mu * mu;
+        mean = mu;
+        invStd = zNormInvStd(mu, variance);
+    }
+
+    // Media e inverso della deviazione standard delle finestre successive di
+    // una serie, con somme scorrevoli di valori e quadrati (come FftDistance):
+    // la prima finestra costa O(queryLength), ogni spostamento O(1). Calcolo
+    // scalare, quindi identico tra le ISA; le finestre vanno richieste in ordine
+    class RunningWindowStats
+    {
+    public:
+        RunningWindowStats(const double *series, size_t queryLength) : series(series), queryLength(queryLength) {}
+
+        // Statistiche delle prossime count finestre
+        void next(size_t count, double *mean, double *invStd)
+        {
+            for (size_t o = 0; o < count; ++o, ++offset)
+            {
+                if (offset == 0)
+                {
+                    for (size_t k = 0; k < queryLength; ++k)
+                    {
+                        sum += series[k];
+                        sumSquares += series[k] * series[k];
+                    }
+                }
+                else
+                {
+                    double in = series[offset + queryLength - 1];
+                    double out = series[offset - 1];
+                    sum += in - out;
+                    sumSquares += in * in - out * out;
+                }
+                setWindowStats(sum, sumSquares, queryLength, mean[o], invStd[o]);
+            }
+        }
+
+    private:
+        const double *series;
+        size_t queryLength;
+        size_t offset = 0;
+        double sum = 0.0;
+        double sumSquares = 0.0;
+    };
+
+    // Istanze per ISA dei due loop vettorizzati
+    struct BaselineIsa
+    {
+        template <typename Metric>
+        static void accumulate(const double *series, const double *query, size_t queryLength, size_t numOffsets,
+                               const double *mean, const double *invStd, double *acc)
+        {
+            accumulateBody<Metric, Vec128>(series, query, queryLength, numOffsets, mean, invStd, acc);
+        }
+    };
+
+#ifdef DISTANCE_KERNELS_X86
+    struct AVX2Isa
+    {
+        template <typename Metric>
+        __attribute__((target("avx2"))) static void accumulate(const double *series, const double *query,
+                                                               size_t queryLength, size_t numOffsets,
+                                                               const double *mean, const double *invStd, double *acc)
+        {
+            accumulateBody<Metric, Vec256>(series, query, queryLength, numOffsets, mean, invStd, acc);
+        }
+    };
+
+    struct AVX512Isa
+    {
+        template <typename Metric>
+        __attribute__((target("avx512f"))) static void accumulate(const double *series, const double *query,
+                                                                  size_t queryLength, size_t numOffsets,
+                                                                  const double *mean, const double *invStd, double *acc)
+        {
+            accumulateBody<Metric, Vec512>(series, query, queryLength, numOffsets, mean, invStd, acc);
+        }
+    };
+#endif
+
+    // Statistiche delle finestre solo per le metriche normalizzate
+    template <typename Metric>
+    inline void windowStats(RunningWindowStats &stats, size_t count, double *mean, double *invStd)
+    {
+        if constexpr (Metric::normalized)
+        {
+            stats.next(count, mean, invStd);
+        }
+    }
+
+    template <typename Metric, typename Isa>
+    void accumulatePlain(const double *series, const double *query, size_t queryLength, size_t numOffsets, double *acc)
+    {
+        Isa::template accumulate<Metric>(series, query, queryLength, numOffsets, nullptr, nullptr, acc);
+    }
+
+    // Distanze di count <= STATS_CHUNK finestre consecutive, con le statistiche
+    // prese in ordine da stats
+    template <typename Metric, typename Isa>
+    void distanceChunk(const double *series, const double *query, size_t queryLength, size_t count,
+                       RunningWindowStats &stats, double *out)
+    {
+        double mean[STATS_CHUNK];
+        double invStd[STATS_CHUNK];
+        windowStats<Metric>(stats, count, mean, invStd);
+        std::fill(out, out + count, 0.0);
+        Isa::template accumulate<Metric>(series, query, queryLength, count, mean, invStd, out);
+    }
+
+    template <typename Metric, typename Isa>
+    void slidingDistance(const double *series, const double *query, size_t queryLength, size_t numOffsets, double *out)
+    {
+        RunningWindowStats stats(series, queryLength);
+
+        for (size_t j = 0; j < numOffsets; j += STATS_CHUNK)
+        {
+            size_t count = std::min(STATS_CHUNK, numOffsets - j);
+            distanceChunk<Metric, Isa>(series + j, query, queryLength, count, stats, out + j);
+        }
+    }
+
+    template <typename Metric, typename Isa>
+    double minDistance(const double *series, const double *query, size_t queryLength, size_t numOffsets)
+    {
+        RunningWindowStats stats(series, queryLength);
+        double buffer[STATS_CHUNK];
+        double minDistance = std::numeric_limits<double>::max();
+
+        for (size_t j = 0; j < numOffsets; j += STATS_CHUNK)
+        {
+            size_t count = std::min(STATS_CHUNK, numOffsets - j);
+            distanceChunk<Metric, Isa>(series + j, query, queryLength, count, stats, buffer);
+            for (size_t o = 0; o < count; ++o)
+            {
+                minDistance = std::min(minDistance, buffer[o]);
+            }
+        }
+
+        return minDistance;
+    }
+
+    // Un gruppo di ABANDON_GROUP offset: false se abbandonato (tutte le
+    // distanze parziali oltre la soglia), altrimenti acc contiene le distanze esatte
+    template <typename Metric, typename Isa>
+    bool groupDistance(const double *series, const double *query, size_t queryLength, size_t count,
+                       const double *mean, const double *invStd, double threshold, double *acc, size_t &evaluated)
+    {
+        std::fill(acc, acc + count, 0.0);
+
+        for (size_t k = 0; k < queryLength; k += ABANDON_BLOCK)
+        {
+            size_t block = std::min(ABANDON_BLOCK, queryLength - k);
+            Isa::template accumulate<Metric>(series + k, query + k, block, count, mean, invStd, acc);
+            evaluated += block * count;
+
+            if (k + block < queryLength && *std::min_element(acc, acc + count) > threshold)
+                return false;
+        }
+
+        return true;
+    }
+
+    template <typename Metric, typename Isa>
+    double minDistanceEarlyAbandon(const double *series, const double *query, size_t queryLength,
+                                   size_t numOffsets, double threshold, size_t *evaluatedTerms)
+    {
+        RunningWindowStats stats(series, queryLength);
+        double mean[STATS_CHUNK];
+        double invStd[STATS_CHUNK];
+        double acc[ABANDON_GROUP];
+        double minDistance = std::numeric_limits<double>::max();
+        size_t evaluated = 0;
+
+        for (size_t c = 0; c < numOffsets; c += STATS_CHUNK)
+        {
+            size_t chunk = std::min(STATS_CHUNK, numOffsets - c);
+            windowStats<Metric>(stats, chunk, mean, invStd);
+
+            for (size_t g = 0; g < chunk; g += ABANDON_GROUP)
+            {
+                size_t count = std::min(ABANDON_GROUP, chunk - g);
+                if (!groupDistance<Metric, Isa>(series + c + g, query, queryLength, count,
+                                                      mean + g, invStd + g, threshold, acc, evaluated))
+                    continue;
+
+                minDistance = std::min(minDistance, *std::min_element(acc, acc + count));
+                threshold = std::min(threshold, minDistance);
+            }
+        }
+
+        if (evaluatedTerms != nullptr)
+        {
+            *evaluatedTerms += evaluated;
+        }
+
+        return minDistance;
+    }
+
+    template <typename Metric, typename Isa>
+    void slidingDistanceEarlyAbandon(const double *series, const double *query, size_t queryLength,
+                                     size_t numOffsets, double threshold, double *out, size_t *evaluatedTerms)
+    {
+        RunningWindowStats stats(series, queryLength);
+        double mean[STATS_CHUNK];
+        double invStd[STATS_CHUNK];
+        size_t evaluated = 0;
+
+        for (size_t c = 0; c < numOffsets; c += STATS_CHUNK)
+        {
+            size_t chunk = std::min(STATS_CHUNK, numOffsets - c);
+            windowStats<Metric>(stats, chunk, mean, invStd);
+
+            for (size_t g = 0; g < chunk; g += ABANDON_GROUP)
+            {
+                size_t count = std::min(ABANDON_GROUP, chunk - g);
+                groupDistance<Metric, Isa>(series + c + g, query, queryLength, count,
+                                                  mean + g, invStd + g, threshold, out + c + g, evaluated);
+            }
+        }
+
+        if (evaluatedTerms != nullptr)
+        {
+            *evaluatedTerms += evaluated;
+        }
+    }
+
+    template <typename Metric, typename Isa>
+    constexpr SadKernel makeMetricKernel(SimdIsa isa, const char *name)
+    {
+        return {isa, name,
+                Metric::normalized ? nullptr : accumulatePlain<Metric, Isa>,
+                slidingDistance<Metric, Isa>,
+                minDistance<Metric, Isa>,
+                minDistanceEarlyAbandon<Metric, Isa>,
+                slidingDistanceEarlyAbandon<Metric, Isa>};
+    }
+
+    // Kernel di una metrica per ciascuna ISA (indice = SimdIsa); SSE2 è la
+    // baseline x86-64, quindi coincide con la versione compilata senza target
+    template <typename Metric>
+    struct MetricKernels
+    {
+        static const SadKernel &get(SimdIsa isa)
+        {
+            static const SadKernel baseline = makeMetricKernel<Metric, BaselineIsa>(SimdIsa::Scalar, "scalar");
+#ifdef DISTANCE_KERNELS_X86
+            static const SadKernel sse2 = makeMetricKernel<Metric, BaselineIsa>(SimdIsa::SSE2, "sse2");
+            static const SadKernel avx2 = makeMetricKernel<Metric, AVX2Isa>(SimdIsa::AVX2, "avx2");
+            static const SadKernel avx512 = makeMetricKernel<Metric, AVX512Isa>(SimdIsa::AVX512, "avx512");
+
+            switch (isa)
+            {
+            case SimdIsa::SSE2:
+                return sse2;
+            case SimdIsa::AVX2:
+                return avx2;
+            case SimdIsa::AVX512:
+                return avx512;
+            default:
+                break;
+            }
+#endif
+            return baseline;
+        }
+    };
+}
+
+const SadKernel &SadKernels::get(SimdIsa isa, DistanceMetric metric)
+{
+    switch (metric)
+    {
+    case DistanceMetric::SquaredEuclidean:
+        return MetricKernels<SquaredEuclideanMetric>::get(isa);
+    case DistanceMetric::Chebyshev:
+        return MetricKernels<ChebyshevMetric>::get(isa);
+    case DistanceMetric::ZNormEuclidean:
+        return MetricKernels<ZNormEuclideanMetric>::get(isa);
+    default:
+        return get(isa);
+    }
+}
+
+const SadKernel &SadKernels::active(DistanceMetric metric)
+{
+    return get(active().isa, metric);
+}
@@ -0,0 +1,98 @@
+#include "../include/Fft.h"
+#include <cmath>
+#include <utility>
+
+FftPlan::FftPlan(size_t size)
+    : n(nextPowerOfTwo(size)), bitReversed(n), twiddleReal(n > 1 ? n - 1 : 1), twiddleImag(n > 1 ? n - 1 : 1)
+{
+    size_t bits = 0;
+    while ((size_t(1) << bits) < n)
+    {
+        ++bits;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t reversed = 0;
+        for (size_t b = 0; b < bits; ++b)
+        {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bitReversed[i] = reversed;
+    }
+
+    const double pi = std::acos(-1.0);
+    for (size_t half = 1; half < n; half <<= 1)
+    {
+        for (size_t k = 0; k < half; ++k)
+        {
+            double angle = -pi * static_cast<double>(k) / static_cast<double>(half);
+            twiddleReal[half - 1 + k] = std::cos(angle);
+            twiddleImag[half - 1 + k] = std::sin(angle);
+        }
+    }
+}
+
+size_t FftPlan::nextPowerOfTwo(size_t value)
+{
+    size_t power = 1;
+    while (power < value)
+    {
+        power <<= 1;
+    }
+    return power;
+}
+
+void FftPlan::forward(double *real, double *imag) const
+{
+    transform(real, imag, false);
+}
+
+void FftPlan::inverse(double *real, double *imag) const
+{
+    transform(real, imag, true);
+}
+
+void FftPlan::transform(double *real, double *imag, bool inverse) const
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t j = bitReversed[i];
+        if (i < j)
+        {
+            std::swap(real[i], real[j]);
+            std::swap(imag[i], imag[j]);
+        }
+    }
+
+    // L'inversa coincide con la diretta con i twiddle coniugati
+    double sign = inverse ? -1.0 : 1.0;
+
+    for (size_t half = 1; half < n; half <<= 1)
+    {
+        const double *wReal = twiddleReal.data() + half - 1;
+        const double *wImag = twiddleImag.data() + half - 1;
+
+        for (size_t start = 0; start < n; start += 2 * half)
+        {
+            double *aReal = real + start;
+            double *aImag = imag + start;
+            double *bReal = real + start + half;
+            double *bImag = imag + start + half;
+
+#pragma omp simd
+            for (size_t k = 0; k < half; ++k)
+            {
+                double wr = wReal[k];
+                double wi = sign * wImag[k];
+                double tr = bReal[k] * wr - bImag[k] * wi;
+                double ti = bReal[k] * wi + bImag[k] * wr;
+
+                bReal[k] = aReal[k] - tr;
+                bImag[k] = aImag[k] - ti;
+                aReal[k] += tr;
+                aImag[k] += ti;
+            }
+        }
+    }
+}
@@ -0,0 +1,197 @@
+#include "../include/FftDistance.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+bool FftDistance::supports(DistanceMetric metric)
+{
+    return metric == DistanceMetric::SquaredEuclidean || metric == DistanceMetric::ZNormEuclidean;
+}
+
+FftDistance::FftDistance(const double *query, size_t queryLength, DistanceMetric metric)
+    : query(query, query + queryLength), queryLength(queryLength), metric(metric)
+{
+    for (size_t k = 0; k < queryLength; ++k)
+    {
+        querySum += query[k];
+        querySumSquares += query[k] * query[k];
+    }
+
+    if (queryLength == 0)
+        return;
+
+    size_t smallest = std::max(FFT_MIN_BLOCK, FftPlan::nextPowerOfTwo(2 * queryLength));
+    size_t largest = std::max(smallest, FftPlan::nextPowerOfTwo(FFT_BLOCK_FACTOR * queryLength));
+
+    for (size_t size = smallest; size <= largest; size *= 2)
+    {
+        Block block{FftPlan(size), AlignedVector<double>(size, 0.0), AlignedVector<double>(size, 0.0)};
+
+        // Convoluzione con la query invertita: QT[j] = conv[j + m - 1]
+        for (size_t k = 0; k < queryLength; ++k)
+        {
+            block.queryReal[k] = query[queryLength - 1 - k];
+        }
+        block.plan.forward(block.queryReal.data(), block.queryImag.data());
+
+        double scale = 1.0 / static_cast<double>(size);
+        for (size_t f = 0; f < size; ++f)
+        {
+            block.queryReal[f] *= scale;
+            block.queryImag[f] *= scale;
+        }
+
+        blocks.push_back(std::move(block));
+    }
+}
+
+const FftDistance::Block &FftDistance::blockFor(size_t numOffsets) const
+{
+    size_t segmentLength = numOffsets + queryLength - 1;
+    for (const Block &block : blocks)
+    {
+        if (block.plan.size() >= segmentLength)
+            return block;
+    }
+    return blocks.back();
+}
+
+double FftDistance::directCost(size_t numOffsets) const
+{
+    double termCost = metric == DistanceMetric::ZNormEuclidean ? ZNORM_TERM_COST : 1.0;
+    return static_cast<double>(numOffsets) * queryLength * termCost;
+}
+
+double FftDistance::fftCost(size_t numOffsets) const
+{
+    const Block &block = blockFor(numOffsets);
+    size_t size = block.plan.size();
+    size_t offsetsPerBlock = size - queryLength + 1;
+    size_t numBlocks = (numOffsets + offsetsPerBlock - 1) / offsetsPerBlock;
+    size_t numTransforms = (numBlocks + 1) / 2;
+
+    // Trasformata diretta e inversa per ogni coppia di blocchi
+    return numTransforms * 2.0 * size * std::log2(static_cast<double>(size)) * FFT_POINT_COST;
+}
+
+bool FftDistance::preferred(size_t numOffsets) const
+{
+    return !blocks.empty() && numOffsets > 0 && fftCost(numOffsets) < directCost(numOffsets);
+}
+
+size_t FftDistance::crossoverLength() const
+{
+    if (blocks.empty())
+        return 0;
+
+    // Il vantaggio dell'FFT cresce con la lunghezza: basta trovare il primo punto
+    // (a meno dei gradini dovuti alla dimensione dei blocchi)
+    size_t maxOffsets = 64 * blocks.back().plan.size();
+    for (size_t offsets = 1; offsets <= maxOffsets; offsets = std::max(offsets + 1, offsets * 17 / 16))
+    {
+        if (preferred(offsets))
+            return offsets + queryLength - 1;
+    }
+    return 0;
+}
+
+void FftDistance::blockDistances(const double *series, size_t offsets, const double *dots, double *out) const
+{
+    double m = static_cast<double>(queryLength);
+    double sum = 0.0;
+    double sumSquares = 0.0;
+    for (size_t k = 0; k < queryLength; ++k)
+    {
+        sum += series[k];
+        sumSquares += series[k] * series[k];
+    }
+
+    for (size_t j = 0; j < offsets; ++j)
+    {
+        if (j > 0)
+        {
+            double in = series[j + queryLength - 1];
+            double out = series[j - 1];
+            sum += in - out;
+            sumSquares += in * in - out * out;
+        }
+
+        double distance;
+        if (metric == DistanceMetric::ZNormEuclidean)
+        {
+            double mean = sum / m;
+            double variance = std::max(0.0, sumSquares / m - mean * mean);
+            double invStd = zNormInvStd(mean, variance);
+            double windowEnergy = invStd * invStd * variance * m;
+            distance = windowEnergy - 2.0 * invStd * (dots[j] - mean * querySum) + querySumSquares;
+        }
+        else
+        {
+            distance = sumSquares - 2.0 * dots[j] + querySumSquares;
+        }
+
+        out[j] = std::max(0.0, distance);
+    }
+}
+
+void FftDistance::slidingDistance(const double *series, size_t numOffsets, double *out, FftScratch &scratch) const
+{
+    if (numOffsets == 0)
+        return;
+
+    const Block &block = blockFor(numOffsets);
+    size_t size = block.plan.size();
+    size_t offsetsPerBlock = size - queryLength + 1;
+    size_t segmentLength = numOffsets + queryLength - 1;
+    AlignedVector<double> &real = scratch.real;
+    AlignedVector<double> &imag = scratch.imag;
+    real.resize(size);
+    imag.resize(size);
+
+    auto sample = [&](size_t index)
+    {
+        return index < segmentLength ? series[index] : 0.0;
+    };
+
+    // Due blocchi consecutivi per trasformata: il primo nella parte reale, il secondo nella immaginaria
+    for (size_t first = 0; first < numOffsets; first += 2 * offsetsPerBlock)
+    {
+        size_t second = first + offsetsPerBlock;
+        for (size_t t = 0; t < size; ++t)
+        {
+            real[t] = sample(first + t);
+            imag[t] = sample(second + t);
+        }
+
+        block.plan.forward(real.data(), imag.data());
+        for (size_t f = 0; f < size; ++f)
+        {
+            double re = real[f] * block.queryReal[f] - imag[f] * block.queryImag[f];
+            double im = real[f] * block.queryImag[f] + imag[f] * block.queryReal[f];
+            real[f] = re;
+            imag[f] = im;
+        }
+        block.plan.inverse(real.data(), imag.data());
+
+        size_t firstCount = std::min(offsetsPerBlock, numOffsets - first);
+        std::copy(real.begin() + queryLength - 1, real.begin() + queryLength - 1 + firstCount, out + first);
+        blockDistances(series + first, firstCount, out + first, out + first);
+
+        if (second < numOffsets)
+        {
+            size_t secondCount = std::min(offsetsPerBlock, numOffsets - second);
+            std::copy(imag.begin() + queryLength - 1, imag.begin() + queryLength - 1 + secondCount, out + second);
+            blockDistances(series + second, secondCount, out + second, out + second);
+        }
+    }
+}
+
+double FftDistance::minDistance(const double *series, size_t numOffsets, FftScratch &scratch) const
+{
+    if (numOffsets == 0)
+        return std::numeric_limits<double>::max();
+
+    scratch.distances.resize(numOffsets);
+    slidingDistance(series, numOffsets, scratch.distances.data(), scratch);
+    return *std::min_element(scratch.distances.begin(), scratch.distances.begin() + numOffsets);
+}
@@ -0,0 +1,174 @@
+#include "../include/LowerBounds.h"
+#include "../include/SearchEngine.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    inline double distanceToRange(double value, double lower, double upper)
+    {
+        if (value > upper)
+            return value - upper;
+        if (value < lower)
+            return lower - value;
+        return 0.0;
+    }
+}
+
+LowerBoundCascade::LowerBoundCascade(const double *query, size_t queryLength)
+    : query(query), queryLength(queryLength)
+{
+    size_t numSegments = (queryLength + PAA_SEGMENT - 1) / PAA_SEGMENT;
+    segmentSums.assign(numSegments, 0.0);
+    for (size_t k = 0; k < queryLength; ++k)
+    {
+        segmentSums[k / PAA_SEGMENT] += query[k];
+    }
+}
+
+double LowerBoundCascade::envelopeBound(double seriesMin, double seriesMax) const
+{
+    // Ogni termine è <= |s - q_k| per qualsiasi s nel range e la somma segue
+    // l'ordine di k del kernel: il bound non supera mai la SAD calcolata
+    double bound = 0.0;
+    for (size_t k = 0; k < queryLength; ++k)
+    {
+        bound += distanceToRange(query[k], seriesMin, seriesMax);
+    }
+    return bound;
+}
+
+bool LowerBoundCascade::paaPrunesGroup(const double *prefix, size_t count, double limit) const
+{
+    // Bound di tutte le finestre del gruppo in parallelo (un offset per lane).
+    // Anche il bound parziale è un lower bound: ogni PAA_CHECK segmenti si
+    // verifica se tutte le finestre hanno già superato il limite
+    double bounds[GROUP_SIZE] = {};
+
+    for (size_t seg = 0; seg < segmentSums.size(); ++seg)
+    {
+        size_t begin = seg * PAA_SEGMENT;
+        size_t end = std::min(begin + PAA_SEGMENT, queryLength);
+        double querySum = segmentSums[seg];
+
+#pragma omp simd
+        for (size_t o = 0; o < count; ++o)
+        {
+            bounds[o] += std::abs((prefix[o + end] - prefix[o + begin]) - querySum);
+        }
+
+        if ((seg + 1) % PAA_CHECK == 0 && *std::min_element(bounds, bounds + count) > limit)
+            return true;
+    }
+
+    return *std::min_element(bounds, bounds + count) > limit;
+}
+
+double LowerBoundCascade::groupEnvelopeBound(const double *series, size_t count, double threshold,
+                                             CascadeScratch &scratch) const
+{
+    // Min/max scorrevoli di ampiezza count (van Herk / Gil-Werman): per ogni k
+    // [lower_k, upper_k] contiene series[o + k] per tutti gli offset o del gruppo
+    size_t span = queryLength + count - 1;
+    scratch.prefixMin.resize(span);
+    scratch.prefixMax.resize(span);
+    scratch.suffixMin.resize(span);
+    scratch.suffixMax.resize(span);
+    double *prefixMin = scratch.prefixMin.data();
+    double *prefixMax = scratch.prefixMax.data();
+    double *suffixMin = scratch.suffixMin.data();
+    double *suffixMax = scratch.suffixMax.data();
+
+    for (size_t x = 0; x < span; ++x)
+    {
+        bool blockStart = x % count == 0;
+        prefixMin[x] = blockStart ? series[x] : std::min(prefixMin[x - 1], series[x]);
+        prefixMax[x] = blockStart ? series[x] : std::max(prefixMax[x - 1], series[x]);
+    }
+
+    for (size_t x = span; x-- > 0;)
+    {
+        bool blockEnd = x == span - 1 || (x + 1) % count == 0;
+        suffixMin[x] = blockEnd ? series[x] : std::min(suffixMin[x + 1], series[x]);
+        suffixMax[x] = blockEnd ? series[x] : std::max(suffixMax[x + 1], series[x]);
+    }
+
+    double bound = 0.0;
+    for (size_t k = 0; k < queryLength && bound <= threshold; ++k)
+    {
+        double lower = std::min(suffixMin[k], prefixMin[k + count - 1]);
+        double upper = std::max(suffixMax[k], prefixMax[k + count - 1]);
+        bound += distanceToRange(query[k], lower, upper);
+    }
+
+    return bound;
+}
+
+double LowerBoundCascade::minSad(const SadKernel &kernel, const double *series, size_t numOffsets,
+                                 double threshold, CascadeScratch &scratch, SearchStats &stats) const
+{
+    // Somme prefisse sull'intervallo coperto dagli offset, calcolate una volta per chiamata
+    size_t span = numOffsets + queryLength - 1;
+    scratch.prefix.resize(span + 1);
+    double *prefix = scratch.prefix.data();
+    double sumAbs = 0.0;
+
+    prefix[0] = 0.0;
+    for (size_t x = 0; x < span; ++x)
+    {
+        prefix[x + 1] = prefix[x] + series[x];
+        sumAbs += std::abs(series[x]);
+    }
+
+    // Margine che copre l'arrotondamento delle differenze di somme prefisse
+    // e della SAD calcolata, così il PAA non scarta mai una finestra valida
+    const double eps = std::numeric_limits<double>::epsilon();
+    double paaTolerance = 2.0 * eps * (segmentSums.size() + 1) * span * sumAbs;
+
+    double minSad = std::numeric_limits<double>::max();
+
+    for (size_t j = 0; j < numOffsets; j += GROUP_SIZE)
+    {
+        size_t count = std::min(GROUP_SIZE, numOffsets - j);
+        double bound = std::min(threshold, minSad);
+        stats.windowsTotal += count;
+
+        // Finché non esiste una soglia nessun bound può scartare nulla
+        if (bound < std::numeric_limits<double>::max())
+        {
+            double limit = bound + paaTolerance + 2.0 * eps * queryLength * bound;
+            if (paaPrunesGroup(prefix + j, count, limit))
+            {
+                stats.windowsPrunedPaa += count;
+                continue;
+            }
+
+            // L'envelope di gruppo costa O(m): viene disattivato per il resto
+            // della ricerca del thread se non scarta abbastanza gruppi
+            bool envelopeUseful = scratch.envelopeAttempts < ENVELOPE_PROBE ||
+                                  scratch.envelopeHits * ENVELOPE_MIN_HIT_RATIO >= scratch.envelopeAttempts;
+            if (envelopeUseful)
+            {
+                scratch.envelopeAttempts++;
+                if (groupEnvelopeBound(series + j, count, bound, scratch) > bound)
+                {
+                    scratch.envelopeHits++;
+                    stats.windowsPrunedEnvelope += count;
+                    continue;
+                }
+            }
+        }
+
+        double sad = kernel.minSadEarlyAbandon(series + j, query, queryLength, count, bound,
+                                               &stats.evaluatedTerms);
+        stats.windowsExact += count;
+
+        if (sad < minSad)
+        {
+            minSad = sad;
+        }
+    }
+
+    return minSad;
+}
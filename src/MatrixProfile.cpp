@@ -0,0 +1,416 @@
+#include "../include/MatrixProfile.h"
+#include "../include/DistanceMetrics.h"
+#include "../include/SeriesView.h"
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <omp.h>
+
+namespace
+{
+    // Serie copiate in un unico buffer contiguo con le statistiche di ogni finestra
+    struct ProfileData
+    {
+        size_t windowLength;
+        AlignedVector<double> values;
+        std::vector<size_t> seriesStart;    // primo campione di ogni serie in values
+        std::vector<size_t> windowOffsets;  // prima finestra globale di ogni serie
+        AlignedVector<double> mean;
+        AlignedVector<double> invStd;       // 0 per le finestre costanti
+        AlignedVector<double> energy;       // sum zs^2: windowLength, 0 per le finestre costanti
+    };
+
+    // Tile: diagonali [firstDiagonal, firstDiagonal + TILE_DIAGONALS) della
+    // matrice tra le finestre delle serie rowSeries (righe) e columnSeries
+    // (colonne), righe [firstRow, firstRow + TILE_ROWS)
+    struct Tile
+    {
+        size_t rowSeries;
+        size_t columnSeries;
+        int64_t firstDiagonal;
+        size_t firstRow;
+    };
+
+    // Migliori vicini trovati da un tile per le sue righe e colonne
+    // (al più TILE_ROWS righe e TILE_ROWS + TILE_DIAGONALS - 1 colonne)
+    struct TileProfile
+    {
+        double rowDistances[MatrixProfile::TILE_ROWS];
+        size_t rowNeighbors[MatrixProfile::TILE_ROWS];
+        double columnDistances[MatrixProfile::TILE_ROWS + MatrixProfile::TILE_DIAGONALS];
+        size_t columnNeighbors[MatrixProfile::TILE_ROWS + MatrixProfile::TILE_DIAGONALS];
+    };
+
+    // Lock per blocchi di LOCK_STRIPE finestre del profilo condiviso: ogni tile
+    // fonde il proprio risultato una volta sola, quindi la contesa è minima
+    // e la memoria resta O(finestre) a qualsiasi numero di thread
+    constexpr size_t LOCK_STRIPE = 4096;
+
+    template <typename Dataset>
+    ProfileData prepare(const Dataset &dataset, size_t windowLength)
+    {
+        ProfileData data;
+        data.windowLength = windowLength;
+        size_t numSeries = dataset.getNumSeries();
+        data.seriesStart.resize(numSeries + 1, 0);
+        data.windowOffsets.resize(numSeries + 1, 0);
+
+        for (size_t i = 0; i < numSeries; ++i)
+        {
+            size_t length = dataset.getSeriesLength(i);
+            size_t windows = windowLength > 0 && length >= windowLength ? length - windowLength + 1 : 0;
+            data.seriesStart[i + 1] = data.seriesStart[i] + length;
+            data.windowOffsets[i + 1] = data.windowOffsets[i] + windows;
+        }
+
+        data.values.resize(data.seriesStart[numSeries]);
+        size_t numWindows = data.windowOffsets[numSeries];
+        data.mean.resize(numWindows);
+        data.invStd.resize(numWindows);
+        data.energy.resize(numWindows);
+
+#pragma omp parallel
+        {
+            AlignedVector<double> scratch;
+
+#pragma omp for schedule(dynamic)
+            for (size_t i = 0; i < numSeries; ++i)
+            {
+                auto series = dataset.getSeries(i);
+                const double *values = contiguousValues(series, scratch);
+                double *target = data.values.data() + data.seriesStart[i];
+                std::copy(values, values + series.size(), target);
+
+                for (size_t w = data.windowOffsets[i]; w < data.windowOffsets[i + 1]; ++w)
+                {
+                    const double *window = target + (w - data.windowOffsets[i]);
+                    double sum = 0.0;
+                    double sumSquares = 0.0;
+                    for (size_t k = 0; k < windowLength; ++k)
+                    {
+                        sum += window[k];
+                        sumSquares += window[k] * window[k];
+                    }
+
+                    double mean = sum / windowLength;
+                    double variance = std::max(0.0, sumSquares / windowLength - mean * mean);
+                    data.mean[w] = mean;
+                    data.invStd[w] = zNormInvStd(mean, variance);
+                    data.energy[w] = data.invStd[w] > 0.0 ? static_cast<double>(windowLength) : 0.0;
+                }
+            }
+        }
+
+        return data;
+    }
+
+    std::vector<Tile> makeTiles(const ProfileData &data, bool acrossSeries)
+    {
+        const int64_t band = MatrixProfile::TILE_DIAGONALS;
+        size_t numSeries = data.windowOffsets.size() - 1;
+        int64_t exclusion = static_cast<int64_t>(MatrixProfile::exclusionZone(data.windowLength));
+        std::vector<Tile> tiles;
+
+        for (size_t p = 0; p < numSeries; ++p)
+        {
+            int64_t rows = data.windowOffsets[p + 1] - data.windowOffsets[p];
+            for (size_t q = p; q < (acrossSeries ? numSeries : p + 1); ++q)
+            {
+                int64_t columns = data.windowOffsets[q + 1] - data.windowOffsets[q];
+                if (rows == 0 || columns == 0)
+                    continue;
+
+                // Self-join: solo il triangolo superiore oltre la zona di esclusione (simmetrico)
+                int64_t firstDiagonal = p == q ? exclusion : -(rows - 1);
+                for (int64_t k0 = firstDiagonal; k0 < columns; k0 += band)
+                {
+                    // Righe in cui almeno una diagonale della banda è dentro la matrice
+                    int64_t rowBegin = std::max<int64_t>(0, -(k0 + band - 1));
+                    int64_t rowEnd = std::min<int64_t>(rows, columns - k0);
+                    for (int64_t i0 = rowBegin; i0 < rowEnd; i0 += MatrixProfile::TILE_ROWS)
+                    {
+                        tiles.push_back({p, q, k0, static_cast<size_t>(i0)});
+                    }
+                }
+            }
+        }
+
+        return tiles;
+    }
+
+    inline double dot(const double *a, const double *b, size_t length)
+    {
+        double sum = 0.0;
+        for (size_t k = 0; k < length; ++k)
+        {
+            sum += a[k] * b[k];
+        }
+        return sum;
+    }
+
+    inline bool better(double distance, size_t neighbor, double currentDistance, size_t currentNeighbor)
+    {
+        return distance < currentDistance || (distance == currentDistance && neighbor < currentNeighbor);
+    }
+
+    // Fonde count finestre consecutive a partire da first nel profilo condiviso
+    void mergeRange(MatrixProfileResult &result, std::vector<omp_lock_t> &locks, size_t first, size_t count,
+                    const double *distances, const size_t *neighbors)
+    {
+        size_t end = first + count;
+        while (first < end)
+        {
+            size_t stripe = first / LOCK_STRIPE;
+            size_t stripeEnd = std::min(end, (stripe + 1) * LOCK_STRIPE);
+
+            omp_set_lock(&locks[stripe]);
+            for (size_t w = first; w < stripeEnd; ++w)
+            {
+                if (better(*distances, *neighbors, result.distances[w], result.neighbors[w]))
+                {
+                    result.distances[w] = *distances;
+                    result.neighbors[w] = *neighbors;
+                }
+                ++distances;
+                ++neighbors;
+            }
+            omp_unset_lock(&locks[stripe]);
+
+            first = stripeEnd;
+        }
+    }
+
+    void processTile(const ProfileData &data, const Tile &tile, TileProfile &profile,
+                     MatrixProfileResult &result, std::vector<omp_lock_t> &locks)
+    {
+        const int64_t band = MatrixProfile::TILE_DIAGONALS;
+        const size_t m = data.windowLength;
+        const double *a = data.values.data() + data.seriesStart[tile.rowSeries];
+        const double *b = data.values.data() + data.seriesStart[tile.columnSeries];
+        size_t rowBase = data.windowOffsets[tile.rowSeries];
+        size_t columnBase = data.windowOffsets[tile.columnSeries];
+        int64_t rows = data.windowOffsets[tile.rowSeries + 1] - rowBase;
+        int64_t columns = data.windowOffsets[tile.columnSeries + 1] - columnBase;
+        int64_t k0 = tile.firstDiagonal;
+
+        int64_t rowBegin = std::max<int64_t>(tile.firstRow, -(k0 + band - 1));
+        int64_t rowEnd = std::min<int64_t>({static_cast<int64_t>(tile.firstRow + MatrixProfile::TILE_ROWS), rows, columns - k0});
+
+        if (rowBegin >= rowEnd)
+            return;
+
+        double qt[MatrixProfile::TILE_DIAGONALS];
+        double distance[MatrixProfile::TILE_DIAGONALS];
+
+        // Colonne del tile: da rowBegin + k0 (limitata a 0) a rowEnd - 1 + k0 + band - 1
+        int64_t columnBegin = std::max<int64_t>(0, rowBegin + k0);
+        int64_t columnEnd = std::min<int64_t>(columns, rowEnd - 1 + k0 + band);
+        size_t numRows = rowEnd - rowBegin;
+        size_t numColumns = columnEnd - columnBegin;
+        std::fill(profile.rowDistances, profile.rowDistances + numRows, std::numeric_limits<double>::max());
+        std::fill(profile.rowNeighbors, profile.rowNeighbors + numRows, MatrixProfileResult::NO_NEIGHBOR);
+        std::fill(profile.columnDistances, profile.columnDistances + numColumns, std::numeric_limits<double>::max());
+        std::fill(profile.columnNeighbors, profile.columnNeighbors + numColumns, MatrixProfileResult::NO_NEIGHBOR);
+
+        for (int64_t i = rowBegin; i < rowEnd; ++i)
+        {
+            // Diagonali valide nella riga i: colonna j = i + k0 + d in [0, columns)
+            int64_t dBegin = std::max<int64_t>(0, -(i + k0));
+            int64_t dEnd = std::min<int64_t>(band, columns - (i + k0));
+            if (dBegin >= dEnd)
+                continue;
+
+            const double *rowWindow = a + i;
+            const double *columnWindow = b + i + k0;
+
+            if (i == rowBegin)
+            {
+                for (int64_t d = dBegin; d < dEnd; ++d)
+                {
+                    qt[d] = dot(rowWindow, columnWindow + d, m);
+                }
+            }
+            else
+            {
+                // La diagonale che entra dalla colonna 0 non ha un valore precedente
+                int64_t dUpdate = dBegin;
+                if (i + k0 + dBegin == 0)
+                {
+                    qt[dBegin] = dot(rowWindow, columnWindow + dBegin, m);
+                    ++dUpdate;
+                }
+
+                double leaving = rowWindow[-1];
+                double entering = rowWindow[m - 1];
+#pragma omp simd
+                for (int64_t d = dUpdate; d < dEnd; ++d)
+                {
+                    qt[d] += entering * columnWindow[d + m - 1] - leaving * columnWindow[d - 1];
+                }
+            }
+
+            size_t row = rowBase + i;
+            double rowMean = data.mean[row];
+            double rowScale = -2.0 * data.invStd[row];
+            double rowEnergy = data.energy[row];
+            const double *columnMean = data.mean.data() + columnBase + i + k0;
+            const double *columnInvStd = data.invStd.data() + columnBase + i + k0;
+            const double *columnEnergy = data.energy.data() + columnBase + i + k0;
+
+            // sum (zs - zq)^2 = Es + Eq - 2 (QT - m mu_s mu_q) / (sigma_s sigma_q)
+#pragma omp simd
+            for (int64_t d = dBegin; d < dEnd; ++d)
+            {
+                double cross = (qt[d] - m * rowMean * columnMean[d]) * rowScale * columnInvStd[d];
+                distance[d] = std::max(0.0, rowEnergy + columnEnergy[d] + cross);
+            }
+
+            // Colonne contigue: aggiornamento senza branch, vettorizzabile
+            double *columnBest = profile.columnDistances + (i + k0 - columnBegin);
+            size_t *columnNeighbor = profile.columnNeighbors + (i + k0 - columnBegin);
+#pragma omp simd
+            for (int64_t d = dBegin; d < dEnd; ++d)
+            {
+                bool better = distance[d] < columnBest[d] || (distance[d] == columnBest[d] && row < columnNeighbor[d]);
+                columnBest[d] = better ? distance[d] : columnBest[d];
+                columnNeighbor[d] = better ? row : columnNeighbor[d];
+            }
+
+            // Riga: un solo aggiornamento con il minimo della banda (a parità la colonna minore)
+            int64_t rowBest = dBegin;
+            for (int64_t d = dBegin + 1; d < dEnd; ++d)
+            {
+                rowBest = distance[d] < distance[rowBest] ? d : rowBest;
+            }
+            profile.rowDistances[i - rowBegin] = distance[rowBest];
+            profile.rowNeighbors[i - rowBegin] = columnBase + i + k0 + rowBest;
+        }
+
+        mergeRange(result, locks, rowBase + rowBegin, numRows, profile.rowDistances, profile.rowNeighbors);
+        mergeRange(result, locks, columnBase + columnBegin, numColumns, profile.columnDistances, profile.columnNeighbors);
+    }
+
+    MatrixProfileResult compute(const ProfileData &data, bool acrossSeries)
+    {
+        size_t numWindows = data.mean.size();
+        std::vector<Tile> tiles = makeTiles(data, acrossSeries);
+
+        MatrixProfileResult result;
+        result.windowLength = data.windowLength;
+        result.windowOffsets = data.windowOffsets;
+        result.distances.assign(numWindows, std::numeric_limits<double>::max());
+        result.neighbors.assign(numWindows, MatrixProfileResult::NO_NEIGHBOR);
+
+        std::vector<omp_lock_t> locks(numWindows / LOCK_STRIPE + 1);
+        for (omp_lock_t &lock : locks)
+        {
+            omp_init_lock(&lock);
+        }
+
+#pragma omp parallel
+        {
+            std::unique_ptr<TileProfile> profile = std::make_unique<TileProfile>();
+
+#pragma omp for schedule(dynamic)
+            for (size_t t = 0; t < tiles.size(); ++t)
+            {
+                processTile(data, tiles[t], *profile, result, locks);
+            }
+        }
+
+        for (omp_lock_t &lock : locks)
+        {
+            omp_destroy_lock(&lock);
+        }
+
+        return result;
+    }
+
+    // true se la finestra globale w si sovrappone (stessa serie, entro la zona di esclusione) a una di chosen
+    bool overlapsAny(const MatrixProfileResult &profile, size_t w, const std::vector<size_t> &chosen)
+    {
+        Match candidate = profile.window(w);
+        size_t zone = MatrixProfile::exclusionZone(profile.windowLength);
+        for (size_t other : chosen)
+        {
+            Match taken = profile.window(other);
+            size_t gap = candidate.offset > taken.offset ? candidate.offset - taken.offset : taken.offset - candidate.offset;
+            if (candidate.seriesIndex == taken.seriesIndex && gap < zone)
+                return true;
+        }
+        return false;
+    }
+}
+
+Match MatrixProfileResult::window(size_t globalIndex) const
+{
+    size_t series = std::upper_bound(windowOffsets.begin(), windowOffsets.end(), globalIndex) - windowOffsets.begin() - 1;
+    return {series, globalIndex - windowOffsets[series], distances[globalIndex]};
+}
+
+MatrixProfileResult MatrixProfile::computeSoA(const TimeSeriesSoA &dataset, size_t windowLength, bool acrossSeries)
+{
+    return compute(prepare(dataset, windowLength), acrossSeries);
+}
+
+MatrixProfileResult MatrixProfile::computeAoS(const TimeSeriesAoS &dataset, size_t windowLength, bool acrossSeries)
+{
+    return compute(prepare(dataset, windowLength), acrossSeries);
+}
+
+std::vector<Motif> MatrixProfile::motifs(const MatrixProfileResult &profile, size_t k)
+{
+    std::vector<size_t> order(profile.numWindows());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t x, size_t y)
+              { return profile.distances[x] < profile.distances[y] ||
+                       (profile.distances[x] == profile.distances[y] && x < y); });
+
+    std::vector<Motif> result;
+    std::vector<size_t> chosen;
+    for (size_t w : order)
+    {
+        if (result.size() >= k)
+            break;
+
+        size_t neighbor = profile.neighbors[w];
+        if (neighbor == MatrixProfileResult::NO_NEIGHBOR || overlapsAny(profile, w, chosen) ||
+            overlapsAny(profile, neighbor, chosen))
+            continue;
+
+        result.push_back({profile.window(w), profile.window(neighbor)});
+        chosen.push_back(w);
+        chosen.push_back(neighbor);
+    }
+    return result;
+}
+
+std::vector<Match> MatrixProfile::discords(const MatrixProfileResult &profile, size_t k)
+{
+    std::vector<size_t> order;
+    for (size_t w = 0; w < profile.numWindows(); ++w)
+    {
+        if (profile.neighbors[w] != MatrixProfileResult::NO_NEIGHBOR)
+        {
+            order.push_back(w);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&](size_t x, size_t y)
+              { return profile.distances[x] > profile.distances[y] ||
+                       (profile.distances[x] == profile.distances[y] && x < y); });
+
+    std::vector<Match> result;
+    std::vector<size_t> chosen;
+    for (size_t w : order)
+    {
+        if (result.size() >= k)
+            break;
+        if (overlapsAny(profile, w, chosen))
+            continue;
+
+        result.push_back(profile.window(w));
+        chosen.push_back(w);
+    }
+    return result;
+}
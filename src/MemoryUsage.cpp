@@ -0,0 +1,28 @@
+#include "../include/MemoryUsage.h"
+#include <fstream>
+#include <sys/resource.h>
+#include <unistd.h>
+
+size_t MemoryUsage::peakRssBytes()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+#endif
+}
+
+size_t MemoryUsage::currentRssBytes()
+{
+    std::ifstream statm("/proc/self/statm");
+    size_t totalPages = 0;
+    size_t residentPages = 0;
+    if (!(statm >> totalPages >> residentPages))
+        return 0;
+
+    return residentPages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
@@ -0,0 +1,294 @@
+#include "../include/NumaPlacement.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <omp.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+namespace
+{
+    // Valore di MPOL_INTERLEAVE in <numaif.h>, senza dipendere da libnuma
+    constexpr int MPOL_INTERLEAVE_MODE = 3;
+
+    std::string readFirstLine(const std::string &path)
+    {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    }
+
+    // Lista di CPU o nodi nel formato del kernel, es. "0-3,8,10-11"
+    std::vector<int> parseList(const std::string &text)
+    {
+        std::vector<int> values;
+        std::stringstream stream(text);
+        std::string range;
+        while (std::getline(stream, range, ','))
+        {
+            if (range.empty())
+                continue;
+
+            size_t dash = range.find('-');
+            try
+            {
+                int first = std::stoi(range.substr(0, dash));
+                int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+                for (int value = first; value <= last; ++value)
+                {
+                    values.push_back(value);
+                }
+            }
+            catch (const std::exception &)
+            {
+                return {};
+            }
+        }
+        return values;
+    }
+
+    std::vector<int> onlineNodes()
+    {
+        std::vector<int> nodes = parseList(readFirstLine("/sys/devices/system/node/online"));
+        return nodes.empty() ? std::vector<int>{0} : nodes;
+    }
+
+    // CPU su cui il thread chiamante può girare
+    std::vector<int> readAllowedCpus()
+    {
+        std::vector<int> cpus;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+            {
+                if (CPU_ISSET(cpu, &set))
+                    cpus.push_back(cpu);
+            }
+        }
+#endif
+        if (cpus.empty())
+        {
+            long count = sysconf(_SC_NPROCESSORS_ONLN);
+            for (int cpu = 0; cpu < std::max(1L, count); ++cpu)
+            {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+
+    // CPU del processo alla prima chiamata, prima che bindThreads restringa
+    // l'affinità del thread principale
+    const std::vector<int> &allowedCpus()
+    {
+        static const std::vector<int> cpus = readAllowedCpus();
+        return cpus;
+    }
+
+    // Copia il buffer in pagine anonime nuove, distribuite secondo policy:
+    // le pagine vengono toccate per la prima volta dalla copia parallela statica
+    template <typename T>
+    bool placeStorage(const FlatStorage<T> &source, NumaPolicy policy, FlatStorage<T> &target)
+    {
+        size_t bytes = source.sizeInBytes();
+        if (bytes == 0)
+            return false;
+
+        void *address = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (address == MAP_FAILED)
+        {
+            std::cerr << "NUMA placement: cannot allocate " << bytes << " bytes" << std::endl;
+            return false;
+        }
+        std::shared_ptr<const void> owner(address, [bytes](const void *pages)
+                                          { munmap(const_cast<void *>(pages), bytes); });
+
+        if (policy == NumaPolicy::Interleave)
+        {
+#ifdef __linux__
+            std::vector<unsigned long> mask(1);
+            for (int node : onlineNodes())
+            {
+                size_t word = node / (8 * sizeof(unsigned long));
+                mask.resize(std::max(mask.size(), word + 1));
+                mask[word] |= 1UL << (node % (8 * sizeof(unsigned long)));
+            }
+            if (syscall(SYS_mbind, address, bytes, MPOL_INTERLEAVE_MODE, mask.data(),
+                        mask.size() * 8 * sizeof(unsigned long), 0) != 0)
+            {
+                std::cerr << "NUMA placement: mbind(MPOL_INTERLEAVE) failed: " << std::strerror(errno) << std::endl;
+                return false;
+            }
+#else
+            return false;
+#endif
+        }
+
+        size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t numPages = (bytes + pageSize - 1) / pageSize;
+        const char *src = reinterpret_cast<const char *>(source.data());
+        char *dst = static_cast<char *>(address);
+
+#pragma omp parallel for schedule(static)
+        for (size_t page = 0; page < numPages; ++page)
+        {
+            size_t begin = page * pageSize;
+            std::memcpy(dst + begin, src + begin, std::min(pageSize, bytes - begin));
+        }
+
+        size_t numSeries = source.getNumSeries();
+        std::vector<size_t> offsets(numSeries);
+        std::vector<size_t> lengths(numSeries);
+        for (size_t i = 0; i < numSeries; ++i)
+        {
+            offsets[i] = source.getOffset(i);
+            lengths[i] = source.getSeriesLength(i);
+        }
+
+        target = FlatStorage<T>::wrap(source.getLayout(), source.getTileWidth(), static_cast<const T *>(address),
+                                      source.size(), std::move(offsets), std::move(lengths),
+                                      source.getRowCapacity(), source.getColumnCapacity(), std::move(owner));
+        return true;
+    }
+
+    template <typename Dataset, typename T>
+    NumaPolicy placeDataset(Dataset &dataset, NumaPolicy policy)
+    {
+        if (policy == NumaPolicy::None || NumaPlacement::numNodes() <= 1)
+            return NumaPolicy::None;
+
+        FlatStorage<T> placed;
+        if (!placeStorage(dataset.getStorage(), policy, placed))
+            return NumaPolicy::None;
+
+        dataset = Dataset(std::move(placed));
+        return policy;
+    }
+}
+
+size_t NumaPlacement::numNodes()
+{
+    return onlineNodes().size();
+}
+
+NumaPolicy NumaPlacement::place(TimeSeriesSoA &dataset, NumaPolicy policy)
+{
+    return placeDataset<TimeSeriesSoA, double>(dataset, policy);
+}
+
+NumaPolicy NumaPlacement::place(TimeSeriesAoS &dataset, NumaPolicy policy)
+{
+    return placeDataset<TimeSeriesAoS, Sample>(dataset, policy);
+}
+
+std::vector<std::vector<int>> NumaPlacement::places(const std::string &kind)
+{
+    const std::vector<int> &cpus = allowedCpus();
+    std::vector<std::vector<int>> result;
+
+    auto allowed = [&](int cpu)
+    {
+        return std::find(cpus.begin(), cpus.end(), cpu) != cpus.end();
+    };
+
+    if (kind == "cores")
+    {
+        // Un place per core fisico: i thread hardware fratelli stanno insieme
+        std::vector<bool> assigned(cpus.empty() ? 0 : cpus.back() + 1, false);
+        for (int cpu : cpus)
+        {
+            if (assigned[cpu])
+                continue;
+
+            std::vector<int> siblings = parseList(readFirstLine(
+                "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list"));
+            std::vector<int> place;
+            for (int sibling : siblings)
+            {
+                if (allowed(sibling) && !assigned[sibling])
+                {
+                    assigned[sibling] = true;
+                    place.push_back(sibling);
+                }
+            }
+            if (place.empty())
+            {
+                assigned[cpu] = true;
+                place.push_back(cpu);
+            }
+            result.push_back(place);
+        }
+    }
+    else if (kind == "numa_domains")
+    {
+        for (int node : onlineNodes())
+        {
+            std::vector<int> place;
+            for (int cpu : parseList(readFirstLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist")))
+            {
+                if (allowed(cpu))
+                    place.push_back(cpu);
+            }
+            if (!place.empty())
+                result.push_back(place);
+        }
+    }
+
+    // "threads", oppure topologia non disponibile: un place per CPU logica
+    if (result.empty())
+    {
+        for (int cpu : cpus)
+        {
+            result.push_back({cpu});
+        }
+    }
+
+    return result;
+}
+
+bool NumaPlacement::bindThreads(const ThreadAffinity &affinity)
+{
+    if (affinity.bind != "close" && affinity.bind != "spread")
+        return false;
+
+#ifdef __linux__
+    std::vector<std::vector<int>> placeList = places(affinity.places);
+    size_t numPlaces = placeList.size();
+    bool spread = affinity.bind == "spread";
+    bool ok = true;
+
+    // Come OMP_PROC_BIND: close riempie i place consecutivi a partire dal
+    // primo, spread distribuisce i thread uniformemente su tutti i place
+#pragma omp parallel reduction(&& : ok)
+    {
+        size_t numThreads = omp_get_num_threads();
+        size_t thread = omp_get_thread_num();
+        size_t place = (!spread && numThreads <= numPlaces) ? thread : thread * numPlaces / numThreads;
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : placeList[place])
+        {
+            CPU_SET(cpu, &set);
+        }
+        ok = sched_setaffinity(0, sizeof(set), &set) == 0;
+    }
+
+    return ok;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,210 @@
+#include "../include/PerfCounters.h"
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <omp.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+namespace
+{
+    std::atomic<bool> enabledFlag(false);
+
+#ifdef __linux__
+    // Tipo e configurazione perf di ciascun PerfEvent
+    perf_event_attr eventAttributes(PerfEvent event)
+    {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        switch (event)
+        {
+        case PerfEvent::Cycles:
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PerfEvent::Instructions:
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PerfEvent::L1dMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case PerfEvent::LlcMisses:
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case PerfEvent::BranchMisses:
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        }
+        return attr;
+    }
+
+    // Contatore del thread chiamante, su qualsiasi CPU
+    int openEvent(PerfEvent event)
+    {
+        perf_event_attr attr = eventAttributes(event);
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    // Valore scalato per il multiplexing (contatore attivo solo parte del tempo)
+    bool readEvent(int fd, uint64_t &value)
+    {
+        uint64_t data[3];
+        if (read(fd, data, sizeof(data)) != static_cast<ssize_t>(sizeof(data)))
+            return false;
+
+        double enabled = static_cast<double>(data[1]);
+        double running = static_cast<double>(data[2]);
+        value = (running > 0.0 && running < enabled) ? static_cast<uint64_t>(data[0] * (enabled / running)) : data[0];
+        return true;
+    }
+#endif
+}
+
+std::string perfEventName(PerfEvent event)
+{
+    switch (event)
+    {
+    case PerfEvent::Cycles:
+        return "cycles";
+    case PerfEvent::Instructions:
+        return "instructions";
+    case PerfEvent::L1dMisses:
+        return "l1d_misses";
+    case PerfEvent::LlcMisses:
+        return "llc_misses";
+    case PerfEvent::BranchMisses:
+        return "branch_misses";
+    }
+    return "unknown";
+}
+
+bool PerfCounters::setEnabled(bool enabled, std::string *reason)
+{
+    enabledFlag = false;
+    if (!enabled)
+        return false;
+
+#ifdef __linux__
+    // Basta un evento disponibile: gli altri risultano non disponibili nei campioni
+    int error = 0;
+    for (size_t e = 0; e < NUM_PERF_EVENTS; ++e)
+    {
+        int fd = openEvent(static_cast<PerfEvent>(e));
+        if (fd >= 0)
+        {
+            close(fd);
+            enabledFlag = true;
+            return true;
+        }
+        error = errno;
+    }
+
+    if (reason != nullptr)
+    {
+        std::ifstream paranoid("/proc/sys/kernel/perf_event_paranoid");
+        std::string level;
+        std::getline(paranoid, level);
+        *reason = std::string("perf_event_open: ") + std::strerror(error) +
+                  (level.empty() ? "" : " (perf_event_paranoid = " + level + ")");
+    }
+    return false;
+#else
+    if (reason != nullptr)
+    {
+        *reason = "perf_event_open not available on this platform";
+    }
+    return false;
+#endif
+}
+
+bool PerfCounters::isEnabled()
+{
+    return enabledFlag;
+}
+
+PerfCounters::~PerfCounters()
+{
+    closeAll();
+}
+
+void PerfCounters::start()
+{
+#ifdef __linux__
+    if (!isEnabled())
+        return;
+
+    closeAll();
+    int numThreads = omp_get_max_threads();
+    std::array<int, NUM_PERF_EVENTS> closed;
+    closed.fill(-1);
+    descriptors.assign(numThreads, closed);
+
+    // Ogni thread apre i propri contatori: i thread del team vengono
+    // riutilizzati dalla regione parallela misurata
+#pragma omp parallel num_threads(numThreads)
+    {
+        std::array<int, NUM_PERF_EVENTS> &fds = descriptors[omp_get_thread_num()];
+        for (size_t e = 0; e < NUM_PERF_EVENTS; ++e)
+        {
+            fds[e] = openEvent(static_cast<PerfEvent>(e));
+            if (fds[e] >= 0)
+            {
+                ioctl(fds[e], PERF_EVENT_IOC_RESET, 0);
+                ioctl(fds[e], PERF_EVENT_IOC_ENABLE, 0);
+            }
+        }
+    }
+#endif
+}
+
+void PerfCounters::stop()
+{
+#ifdef __linux__
+    for (std::array<int, NUM_PERF_EVENTS> &fds : descriptors)
+    {
+        for (size_t e = 0; e < NUM_PERF_EVENTS; ++e)
+        {
+            if (fds[e] < 0)
+                continue;
+
+            ioctl(fds[e], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t value = 0;
+            if (readEvent(fds[e], value))
+            {
+                sum.values[e] += value;
+                sum.available[e] = true;
+            }
+        }
+    }
+    closeAll();
+#endif
+}
+
+void PerfCounters::closeAll()
+{
+    for (std::array<int, NUM_PERF_EVENTS> &fds : descriptors)
+    {
+        for (int &fd : fds)
+        {
+            if (fd >= 0)
+            {
+                close(fd);
+                fd = -1;
+            }
+        }
+    }
+    descriptors.clear();
+}
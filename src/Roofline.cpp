@@ -0,0 +1,146 @@
+#include "../include/Roofline.h"
+#include "../include/AlignedAllocator.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <omp.h>
+#include <unistd.h>
+
+namespace
+{
+    constexpr int REPETITIONS = 5;
+    constexpr size_t MIN_ARRAY_BYTES = size_t(32) << 20;
+    constexpr size_t MAX_ARRAY_BYTES = size_t(256) << 20;
+
+    // Serie e query del test di picco: 8 KiB per thread, ben dentro la L1
+    constexpr size_t SAD_OFFSETS = 1024;
+    constexpr size_t SAD_QUERY_LENGTH = 32;
+    constexpr int SAD_ITERATIONS = 256;
+
+    volatile double sink = 0.0;
+
+    // Buffer allineato non inizializzato: le pagine sono assegnate dal primo
+    // loop che le scrive, non dal thread che alloca
+    struct AlignedDelete
+    {
+        void operator()(double *ptr) const { AlignedAllocator<double>().deallocate(ptr, 0); }
+    };
+    using UninitializedBuffer = std::unique_ptr<double[], AlignedDelete>;
+
+    UninitializedBuffer uninitializedBuffer(size_t n)
+    {
+        return UninitializedBuffer(AlignedAllocator<double>().allocate(n));
+    }
+
+    // Tempo migliore (s) su REPETITIONS esecuzioni, dopo una di riscaldamento
+    template <typename Body>
+    double bestTime(Body body)
+    {
+        body();
+        double best = std::numeric_limits<double>::max();
+        for (int rep = 0; rep < REPETITIONS; ++rep)
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            body();
+            auto end = std::chrono::high_resolution_clock::now();
+            best = std::min(best, std::chrono::duration<double>(end - start).count());
+        }
+        return best;
+    }
+
+    void triad(double *a, const double *b, const double *c, double scalar, size_t n)
+    {
+#pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < n; ++i)
+        {
+            a[i] = b[i] + scalar * c[i];
+        }
+    }
+
+    void readScan(const double *a, size_t n)
+    {
+        double sum = 0.0;
+#pragma omp parallel for schedule(static) reduction(+ : sum)
+        for (size_t i = 0; i < n; ++i)
+        {
+            sum += a[i];
+        }
+        sink = sum;
+    }
+
+    // Ogni thread ripete minSad sulla propria serie (già in cache)
+    void sadPeak(const SadKernel &kernel, const double *series, size_t seriesStride, const double *query)
+    {
+#pragma omp parallel
+        {
+            const double *own = series + omp_get_thread_num() * seriesStride;
+            double best = std::numeric_limits<double>::max();
+            for (int iteration = 0; iteration < SAD_ITERATIONS; ++iteration)
+            {
+                best = std::min(best, kernel.minSad(own, query, SAD_QUERY_LENGTH, SAD_OFFSETS));
+            }
+            sink = best;
+        }
+    }
+}
+
+size_t Roofline::defaultArrayBytes()
+{
+    size_t llc = 0;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    long l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    llc = static_cast<size_t>(std::max({l3, l2, 0L}));
+#endif
+    // Limite superiore: alcune VM riportano la cache condivisa dell'host intero
+    return std::clamp(4 * llc, MIN_ARRAY_BYTES, MAX_ARRAY_BYTES);
+}
+
+MachineCeilings Roofline::measure(const SadKernel &kernel, size_t arrayBytes)
+{
+    MachineCeilings ceilings;
+    ceilings.threads = omp_get_max_threads();
+    ceilings.arrayBytes = arrayBytes > 0 ? arrayBytes : defaultArrayBytes();
+
+    size_t n = ceilings.arrayBytes / sizeof(double);
+    UninitializedBuffer a = uninitializedBuffer(n);
+    UninitializedBuffer b = uninitializedBuffer(n);
+    UninitializedBuffer c = uninitializedBuffer(n);
+
+    // Primo tocco con la stessa distribuzione statica dei loop misurati
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = 0.0;
+        b[i] = 1.0;
+        c[i] = 2.0;
+    }
+
+    double triadTime = bestTime([&]()
+                                { triad(a.get(), b.get(), c.get(), 3.0, n); });
+    ceilings.triadBytesPerSecond = 3.0 * sizeof(double) * n / triadTime;
+
+    double readTime = bestTime([&]()
+                               { readScan(a.get(), n); });
+    ceilings.readBytesPerSecond = sizeof(double) * n / readTime;
+
+    // Serie distinte per thread, ciascuna su cache line proprie
+    size_t seriesStride = (SAD_OFFSETS + SAD_QUERY_LENGTH + 7) / 8 * 8;
+    AlignedVector<double> series(seriesStride * ceilings.threads);
+    AlignedVector<double> query(SAD_QUERY_LENGTH);
+    for (size_t t = 0; t < series.size(); ++t)
+    {
+        series[t] = static_cast<double>((t * 7) % 13);
+    }
+    for (size_t k = 0; k < query.size(); ++k)
+    {
+        query[k] = static_cast<double>((k * 5) % 11);
+    }
+
+    double sadTime = bestTime([&]()
+                              { sadPeak(kernel, series.data(), seriesStride, query.data()); });
+    ceilings.sadTermsPerSecond = static_cast<double>(ceilings.threads) * SAD_ITERATIONS * SAD_OFFSETS * SAD_QUERY_LENGTH / sadTime;
+
+    return ceilings;
+}
@@ -0,0 +1,365 @@
+#include "../include/SadKernels.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SAD_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+    using AccumulateFn = void (*)(const double *, const double *, size_t, size_t, double *);
+
+    // Numero di offset processati per chiamata da minSadChunked
+    constexpr size_t MIN_SAD_CHUNK = 256;
+
+    // Early abandoning: offset per gruppo e termini tra due controlli della soglia
+    constexpr size_t ABANDON_GROUP = 16;
+    constexpr size_t ABANDON_BLOCK = 16;
+
+    void accumulateSadScalar(const double *series, const double *query,
+                             size_t queryLength, size_t numOffsets, double *acc)
+    {
+        for (size_t j = 0; j < numOffsets; ++j)
+        {
+            double sad = acc[j];
+            for (size_t k = 0; k < queryLength; ++k)
+            {
+                sad += std::abs(series[j + k] - query[k]);
+            }
+            acc[j] = sad;
+        }
+    }
+
+    // Ogni ISA implementa solo il kernel di accumulo: partendo dalle somme
+    // parziali in acc aggiunge i termini nello stesso ordine del loop scalare,
+    // quindi spezzare la query in blocchi non cambia il risultato
+    template <AccumulateFn Accumulate>
+    void slidingSad(const double *series, const double *query,
+                    size_t queryLength, size_t numOffsets, double *out)
+    {
+        std::fill(out, out + numOffsets, 0.0);
+        Accumulate(series, query, queryLength, numOffsets, out);
+    }
+
+    // Il minimo viene calcolato a blocchi di offset su un buffer in stack
+    template <AccumulateFn Accumulate>
+    double minSadChunked(const double *series, const double *query,
+                         size_t queryLength, size_t numOffsets)
+    {
+        double buffer[MIN_SAD_CHUNK];
+        double minSad = std::numeric_limits<double>::max();
+
+        for (size_t j = 0; j < numOffsets; j += MIN_SAD_CHUNK)
+        {
+            size_t count = std::min(MIN_SAD_CHUNK, numOffsets - j);
+            slidingSad<Accumulate>(series + j, query, queryLength, count, buffer);
+            for (size_t o = 0; o < count; ++o)
+            {
+                if (buffer[o] < minSad)
+                {
+                    minSad = buffer[o];
+                }
+            }
+        }
+
+        return minSad;
+    }
+
+    // Gli offset sono processati a gruppi: ogni ABANDON_BLOCK termini si
+    // controlla la minima somma parziale del gruppo e, se supera la soglia,
+    // il gruppo viene abbandonato (la SAD può solo crescere)
+    template <AccumulateFn Accumulate>
+    double minSadEarlyAbandon(const double *series, const double *query,
+                              size_t queryLength, size_t numOffsets,
+                              double threshold, size_t *evaluatedTerms)
+    {
+        double acc[ABANDON_GROUP];
+        double minSad = std::numeric_limits<double>::max();
+        size_t evaluated = 0;
+
+        for (size_t j = 0; j < numOffsets; j += ABANDON_GROUP)
+        {
+            size_t count = std::min(ABANDON_GROUP, numOffsets - j);
+            std::fill(acc, acc + count, 0.0);
+            bool abandoned = false;
+
+            for (size_t k = 0; k < queryLength; k += ABANDON_BLOCK)
+            {
+                size_t block = std::min(ABANDON_BLOCK, queryLength - k);
+                Accumulate(series + j + k, query + k, block, count, acc);
+                evaluated += block * count;
+
+                if (k + block < queryLength && *std::min_element(acc, acc + count) > threshold)
+                {
+                    abandoned = true;
+                    break;
+                }
+            }
+
+            if (abandoned)
+                continue;
+
+            for (size_t o = 0; o < count; ++o)
+            {
+                if (acc[o] < minSad)
+                {
+                    minSad = acc[o];
+                }
+            }
+            threshold = std::min(threshold, minSad);
+        }
+
+        if (evaluatedTerms != nullptr)
+        {
+            *evaluatedTerms += evaluated;
+        }
+
+        return minSad;
+    }
+
+    // Come minSadEarlyAbandon ma con una soglia fissa e la SAD di ogni offset
+    // in out: esatta per i gruppi completati, parziale (> threshold) per quelli abbandonati
+    template <AccumulateFn Accumulate>
+    void slidingSadEarlyAbandon(const double *series, const double *query,
+                                size_t queryLength, size_t numOffsets,
+                                double threshold, double *out, size_t *evaluatedTerms)
+    {
+        size_t evaluated = 0;
+
+        for (size_t j = 0; j < numOffsets; j += ABANDON_GROUP)
+        {
+            size_t count = std::min(ABANDON_GROUP, numOffsets - j);
+            double *acc = out + j;
+            std::fill(acc, acc + count, 0.0);
+
+            for (size_t k = 0; k < queryLength; k += ABANDON_BLOCK)
+            {
+                size_t block = std::min(ABANDON_BLOCK, queryLength - k);
+                Accumulate(series + j + k, query + k, block, count, acc);
+                evaluated += block * count;
+
+                if (k + block < queryLength && *std::min_element(acc, acc + count) > threshold)
+                    break;
+            }
+        }
+
+        if (evaluatedTerms != nullptr)
+        {
+            *evaluatedTerms += evaluated;
+        }
+    }
+
+#ifdef SAD_KERNELS_X86
+    __attribute__((target("sse2"))) void accumulateSadSSE2(const double *series, const double *query,
+                                                         size_t queryLength, size_t numOffsets, double *sums)
+    {
+        const __m128d signMask = _mm_set1_pd(-0.0);
+        size_t j = 0;
+
+        // 4 accumulatori da 2 lane: 8 offset per iterazione
+        for (; j + 8 <= numOffsets; j += 8)
+        {
+            __m128d acc0 = _mm_loadu_pd(sums + j), acc1 = _mm_loadu_pd(sums + j + 2);
+            __m128d acc2 = _mm_loadu_pd(sums + j + 4), acc3 = _mm_loadu_pd(sums + j + 6);
+            for (size_t k = 0; k < queryLength; ++k)
+            {
+                const __m128d q = _mm_set1_pd(query[k]);
+                const double *p = series + j + k;
+                acc0 = _mm_add_pd(acc0, _mm_andnot_pd(signMask, _mm_sub_pd(_mm_loadu_pd(p), q)));
+                acc1 = _mm_add_pd(acc1, _mm_andnot_pd(signMask, _mm_sub_pd(_mm_loadu_pd(p + 2), q)));
+                acc2 = _mm_add_pd(acc2, _mm_andnot_pd(signMask, _mm_sub_pd(_mm_loadu_pd(p + 4), q)));
+                acc3 = _mm_add_pd(acc3, _mm_andnot_pd(signMask, _mm_sub_pd(_mm_loadu_pd(p + 6), q)));
+            }
+            _mm_storeu_pd(sums + j, acc0);
+            _mm_storeu_pd(sums + j + 2, acc1);
+            _mm_storeu_pd(sums + j + 4, acc2);
+            _mm_storeu_pd(sums + j + 6, acc3);
+        }
+
+        for (; j + 2 <= numOffsets; j += 2)
+        {
+            __m128d acc = _mm_loadu_pd(sums + j);
+            for (size_t k = 0; k < queryLength; ++k)
+            {
+                const __m128d q = _mm_set1_pd(query[k]);
+                acc = _mm_add_pd(acc, _mm_andnot_pd(signMask, _mm_sub_pd(_mm_loadu_pd(series + j + k), q)));
+            }
+            _mm_storeu_pd(sums + j, acc);
+        }
+
+        accumulateSadScalar(series + j, query, queryLength, numOffsets - j, sums + j);
+    }
+
+    __attribute__((target("avx2"))) void accumulateSadAVX2(const double *series, const double *query,
+                                                         size_t queryLength, size_t numOffsets, double *sums)
+    {
+        const __m256d signMask = _mm256_set1_pd(-0.0);
+        size_t j = 0;
+
+        // 4 accumulatori da 4 lane: 16 offset per iterazione
+        for (; j + 16 <= numOffsets; j += 16)
+        {
+            __m256d acc0 = _mm256_loadu_pd(sums + j), acc1 = _mm256_loadu_pd(sums + j + 4);
+            __m256d acc2 = _mm256_loadu_pd(sums + j + 8), acc3 = _mm256_loadu_pd(sums + j + 12);
+            for (size_t k = 0; k < queryLength; ++k)
+            {
+                const __m256d q = _mm256_broadcast_sd(query + k);
+                const double *p = series + j + k;
+                acc0 = _mm256_add_pd(acc0, _mm256_andnot_pd(signMask, _mm256_sub_pd(_mm256_loadu_pd(p), q)));
+                acc1 = _mm256_add_pd(acc1, _mm256_andnot_pd(signMask, _mm256_sub_pd(_mm256_loadu_pd(p + 4), q)));
+                acc2 = _mm256_add_pd(acc2, _mm256_andnot_pd(signMask, _mm256_sub_pd(_mm256_loadu_pd(p + 8), q)));
+                acc3 = _mm256_add_pd(acc3, _mm256_andnot_pd(signMask, _mm256_sub_pd(_mm256_loadu_pd(p + 12), q)));
+            }
+            _mm256_storeu_pd(sums + j, acc0);
+            _mm256_storeu_pd(sums + j + 4, acc1);
+            _mm256_storeu_pd(sums + j + 8, acc2);
+            _mm256_storeu_pd(sums + j + 12, acc3);
+        }
+
+        for (; j + 4 <= numOffsets; j += 4)
+        {
+            __m256d acc = _mm256_loadu_pd(sums + j);
+            for (size_t k = 0; k < queryLength; ++k)
+            {
+                const __m256d q = _mm256_broadcast_sd(query + k);
+                acc = _mm256_add_pd(acc, _mm256_andnot_pd(signMask, _mm256_sub_pd(_mm256_loadu_pd(series + j + k), q)));
+            }
+            _mm256_storeu_pd(sums + j, acc);
+        }
+
+        accumulateSadScalar(series + j, query, queryLength, numOffsets - j, sums + j);
+    }
+
+    __attribute__((target("avx512f"))) void accumulateSadAVX512(const double *series, const double *query,
+                                                              size_t queryLength, size_t numOffsets, double *sums)
+    {
+        size_t j = 0;
+
+        // 4 accumulatori da 8 lane: 32 offset per iterazione
+        for (; j + 32 <= numOffsets; j += 32)
+        {
+            __m512d acc0 = _mm512_loadu_pd(sums + j), acc1 = _mm512_loadu_pd(sums + j + 8);
+            __m512d acc2 = _mm512_loadu_pd(sums + j + 16), acc3 = _mm512_loadu_pd(sums + j + 24);
+            for (size_t k = 0; k < queryLength; ++k)
+            {
+                const __m512d q = _mm512_set1_pd(query[k]);
+                const double *p = series + j + k;
+                acc0 = _mm512_add_pd(acc0, _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(p), q)));
+                acc1 = _mm512_add_pd(acc1, _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(p + 8), q)));
+                acc2 = _mm512_add_pd(acc2, _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(p + 16), q)));
+                acc3 = _mm512_add_pd(acc3, _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(p + 24), q)));
+            }
+            _mm512_storeu_pd(sums + j, acc0);
+            _mm512_storeu_pd(sums + j + 8, acc1);
+            _mm512_storeu_pd(sums + j + 16, acc2);
+            _mm512_storeu_pd(sums + j + 24, acc3);
+        }
+
+        for (; j + 8 <= numOffsets; j += 8)
+        {
+            __m512d acc = _mm512_loadu_pd(sums + j);
+            for (size_t k = 0; k < queryLength; ++k)
+            {
+                const __m512d q = _mm512_set1_pd(query[k]);
+                acc = _mm512_add_pd(acc, _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(series + j + k), q)));
+            }
+            _mm512_storeu_pd(sums + j, acc);
+        }
+
+        accumulateSadScalar(series + j, query, queryLength, numOffsets - j, sums + j);
+    }
+#endif
+
+    template <AccumulateFn Accumulate>
+    constexpr SadKernel makeKernel(SimdIsa isa, const char *name)
+    {
+        return {isa, name, Accumulate, slidingSad<Accumulate>, minSadChunked<Accumulate>,
+                minSadEarlyAbandon<Accumulate>, slidingSadEarlyAbandon<Accumulate>};
+    }
+
+    const SadKernel scalarKernel = makeKernel<accumulateSadScalar>(SimdIsa::Scalar, "scalar");
+#ifdef SAD_KERNELS_X86
+    const SadKernel sse2Kernel = makeKernel<accumulateSadSSE2>(SimdIsa::SSE2, "sse2");
+    const SadKernel avx2Kernel = makeKernel<accumulateSadAVX2>(SimdIsa::AVX2, "avx2");
+    const SadKernel avx512Kernel = makeKernel<accumulateSadAVX512>(SimdIsa::AVX512, "avx512");
+#endif
+
+    std::atomic<const SadKernel *> activeKernel{nullptr};
+}
+
+SimdIsa SadKernels::detectIsa()
+{
+#ifdef SAD_KERNELS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SimdIsa::AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SimdIsa::AVX2;
+    if (__builtin_cpu_supports("sse2"))
+        return SimdIsa::SSE2;
+#endif
+    return SimdIsa::Scalar;
+}
+
+bool SadKernels::isSupported(SimdIsa isa)
+{
+    return static_cast<int>(isa) <= static_cast<int>(detectIsa());
+}
+
+const SadKernel &SadKernels::get(SimdIsa isa)
+{
+    switch (isa)
+    {
+#ifdef SAD_KERNELS_X86
+    case SimdIsa::SSE2:
+        return sse2Kernel;
+    case SimdIsa::AVX2:
+        return avx2Kernel;
+    case SimdIsa::AVX512:
+        return avx512Kernel;
+#endif
+    default:
+        return scalarKernel;
+    }
+}
+
+const SadKernel &SadKernels::active()
+{
+    const SadKernel *kernel = activeKernel.load(std::memory_order_acquire);
+    if (kernel == nullptr)
+    {
+        kernel = &get(detectIsa());
+        activeKernel.store(kernel, std::memory_order_release);
+    }
+    return *kernel;
+}
+
+bool SadKernels::setActive(SimdIsa isa)
+{
+    if (!isSupported(isa))
+        return false;
+    activeKernel.store(&get(isa), std::memory_order_release);
+    return true;
+}
+
+std::string SadKernels::isaName(SimdIsa isa)
+{
+    return get(isa).name;
+}
+
+bool SadKernels::parseIsa(const std::string &name, SimdIsa &isa)
+{
+    for (SimdIsa candidate : {SimdIsa::Scalar, SimdIsa::SSE2, SimdIsa::AVX2, SimdIsa::AVX512})
+    {
+        if (name == get(candidate).name)
+        {
+            isa = candidate;
+            return true;
+        }
+    }
+    return false;
+}
@@ -1,76 +1,1014 @@
 #include "../include/SearchEngine.h"
+#include <atomic>
 #include <cmath>
 #include "SearchEngine.h"
+#include "../include/SadKernels.h"
+#include "../include/LowerBounds.h"
+#include "../include/FftDistance.h"
+#include <algorithm>
+#include <numeric>
+#include <optional>
 
-std::pair<std::vector<double>, size_t> SearchEngine::searchSequentialSoA(const TimeSeriesSoA &dataset, const TimeSeries &query)
+namespace
 {
-    std::vector<double> sadValues(dataset.getNumSeries(), std::numeric_limits<double>::max());
-    size_t queryLength = query.getSize();
-    size_t bestIndex = 0;
-    double bestSad = std::numeric_limits<double>::max();
-    const std::vector<double> &queryData = query.getData();
+    // Con una soglia condivisa, ogni quanti offset rileggere il miglior SAD degli altri thread
+    constexpr size_t SHARED_BEST_REFRESH = 1024;
+
+    // Batch: dimensione dei blocchi di serie condivisi da tutte le query (~L2)
+    constexpr size_t BATCH_TILE_BYTES = 256 * 1024;
+
+    // Top-K: offset calcolati tra due aggiornamenti della soglia (buffer in stack)
+    constexpr size_t TOPK_CHUNK = 256;
+
+    // Collapsed: blocchi per thread desiderati e dimensione minima di un blocco
+    // in offset (sotto questa soglia l'overhead di scheduling non si ammortizza)
+    constexpr size_t COLLAPSED_CHUNKS_PER_THREAD = 8;
+    constexpr size_t COLLAPSED_MIN_CHUNK = 256;
+
+    // Tasks: blocchi più piccoli che in collapsed, così il bilanciamento finale
+    // ha granularità fine; le serie corte vengono comunque raggruppate
+    constexpr size_t TASKS_PER_THREAD = 16;
+
+    // Compact: candidati ricalcolati in double per thread in ogni lotto del re-rank
+    constexpr size_t RERANK_BATCH_PER_THREAD = 4;
+
+    // Stato comune a tutte le serie di una ricerca
+    struct SearchContext
+    {
+        SearchContext(const TimeSeries &query, const SearchOptions &options)
+            : kernel(SadKernels::active(options.metric)), queryData(query.getData().data()),
+              queryLength(query.getSize()), options(options)
+        {
+            if (options.metric == DistanceMetric::ZNormEuclidean)
+            {
+                normalizedQuery.resize(queryLength);
+                zNormalize(queryData, queryLength, normalizedQuery.data());
+                queryData = normalizedQuery.data();
+            }
+
+            if (options.lowerBounds && options.metric == DistanceMetric::Sad)
+            {
+                cascade.emplace(queryData, queryLength);
+            }
+
+            if (options.engine != DistanceEngine::Direct && FftDistance::supports(options.metric))
+            {
+                fft.emplace(queryData, queryLength, options.metric);
+            }
+        }
+
+        // Motore FFT per un tratto di serie con questi offset
+        bool useFft(size_t offsets) const
+        {
+            return fft && (options.engine == DistanceEngine::Fft || fft->preferred(offsets));
+        }
+
+        const SadKernel &kernel;
+        const double *queryData;
+        size_t queryLength;
+        const SearchOptions &options;
+        std::optional<LowerBoundCascade> cascade;
+        std::optional<FftDistance> fft;
+        AlignedVector<double> normalizedQuery;
+    };
+
+    // Buffer e contatori privati di ciascun thread
+    struct ThreadState
+    {
+        AlignedVector<double> values;
+        CascadeScratch cascade;
+        FftScratch fft;
+        SearchStats stats;
+    };
+
+    inline size_t numOffsets(size_t seriesLength, size_t queryLength)
+    {
+        return seriesLength >= queryLength ? seriesLength - queryLength + 1 : 0;
+    }
+
+    inline void publishBest(std::atomic<double> &sharedBest, double sad)
+    {
+        double current = sharedBest.load(std::memory_order_relaxed);
+        while (sad < current && !sharedBest.compare_exchange_weak(current, sad, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    // Minimo SAD sugli offset [0, offsets) con la strategia scelta dalle opzioni
+    double rangeMinSad(const SearchContext &context, const double *seriesData, size_t offsets,
+                       double threshold, ThreadState &state)
+    {
+        if (context.cascade)
+        {
+            return context.cascade->minSad(context.kernel, seriesData, offsets, threshold,
+                                           state.cascade, state.stats);
+        }
+
+        if (context.options.earlyAbandon)
+        {
+            return context.kernel.minSadEarlyAbandon(seriesData, context.queryData, context.queryLength,
+                                                     offsets, threshold, &state.stats.evaluatedTerms);
+        }
+
+        state.stats.evaluatedTerms += offsets * context.queryLength;
+        return context.kernel.minSad(seriesData, context.queryData, context.queryLength, offsets);
+    }
+
+    // sharedBest (se non nullo) è la SAD di una finestra già calcolata da un
+    // altro thread e viene usata come soglia aggiuntiva, riletta periodicamente
+    double seriesMinSad(const SearchContext &context, const double *seriesData, size_t offsets,
+                        std::atomic<double> *sharedBest, ThreadState &state)
+    {
+        // L'FFT calcola tutti gli offset insieme: niente soglie
+        if (context.useFft(offsets))
+        {
+            state.stats.evaluatedTerms += offsets * context.queryLength;
+            state.stats.windowsFft += offsets;
+            double distance = context.fft->minDistance(seriesData, offsets, state.fft);
+            if (sharedBest != nullptr)
+            {
+                publishBest(*sharedBest, distance);
+            }
+            return distance;
+        }
+
+        bool pruning = context.options.earlyAbandon || context.cascade;
+        if (sharedBest == nullptr || !pruning)
+        {
+            return rangeMinSad(context, seriesData, offsets, std::numeric_limits<double>::max(), state);
+        }
+
+        double minSad = std::numeric_limits<double>::max();
+        for (size_t j = 0; j < offsets; j += SHARED_BEST_REFRESH)
+        {
+            size_t count = std::min(SHARED_BEST_REFRESH, offsets - j);
+            double threshold = std::min(minSad, sharedBest->load(std::memory_order_relaxed));
+            double sad = rangeMinSad(context, seriesData + j, count, threshold, state);
+            if (sad < minSad)
+            {
+                minSad = sad;
+                publishBest(*sharedBest, sad);
+            }
+        }
+        return minSad;
+    }
+
+    // Livello 0 della cascata: scarta l'intera serie se l'envelope [min, max]
+    // garantisce che nessuna finestra possa battere il miglior SAD globale
+    bool prunedBySeriesEnvelope(const SearchContext &context, const double *seriesData, size_t length,
+                                std::atomic<double> *sharedBest)
+    {
+        if (!context.cascade || sharedBest == nullptr)
+            return false;
+
+        double best = sharedBest->load(std::memory_order_relaxed);
+        if (best == std::numeric_limits<double>::max())
+            return false;
+
+        auto [minIt, maxIt] = std::minmax_element(seriesData, seriesData + length);
+        return context.cascade->envelopeBound(*minIt, *maxIt) > best;
+    }
+
+    // Minimo SAD di una serie eseguito interamente dal thread corrente
+    template <typename T>
+    double searchSeries(const SearchContext &context, const SeriesView<T> &series,
+                        std::atomic<double> *sharedBest, ThreadState &state)
+    {
+        size_t offsets = numOffsets(series.size(), context.queryLength);
+        if (offsets == 0)
+            return std::numeric_limits<double>::max();
+
+        // Lo stride viene risolto una volta per serie, il kernel legge dati contigui
+        const double *seriesData = contiguousValues(series, state.values);
+        state.stats.totalTerms += offsets * context.queryLength;
+        state.stats.seriesTotal++;
+
+        if (prunedBySeriesEnvelope(context, seriesData, series.size(), sharedBest))
+        {
+            state.stats.seriesPrunedEnvelope++;
+            state.stats.windowsTotal += offsets;
+            state.stats.windowsPrunedSeries += offsets;
+            return std::numeric_limits<double>::max();
+        }
+
+        return seriesMinSad(context, seriesData, offsets, sharedBest, state);
+    }
+
+    // Minimo SAD di una serie con gli offset divisi staticamente tra i thread
+    // del team (equivalente a "omp for schedule(static)"). Con early abandon i
+    // thread condividono il minimo della stessa serie, quindi il risultato resta esatto.
+    template <typename T>
+    double parallelSearchSeries(const SearchContext &context, const SeriesView<T> &series,
+                                ThreadState &state)
+    {
+        size_t offsets = numOffsets(series.size(), context.queryLength);
+        if (offsets == 0)
+            return std::numeric_limits<double>::max();
+
+        const double *seriesData = contiguousValues(series, state.values);
+        state.stats.totalTerms += offsets * context.queryLength;
+        state.stats.seriesTotal++;
+
+        double minSad = std::numeric_limits<double>::max();
+        std::atomic<double> seriesBest(std::numeric_limits<double>::max());
+        SearchStats &stats = state.stats;
+
+#pragma omp parallel reduction(min : minSad)
+        {
+            size_t numThreads = omp_get_num_threads();
+            size_t threadId = omp_get_thread_num();
+            size_t begin = offsets * threadId / numThreads;
+            size_t end = offsets * (threadId + 1) / numThreads;
+            ThreadState local;
+
+            if (begin < end)
+            {
+                minSad = seriesMinSad(context, seriesData + begin, end - begin, &seriesBest, local);
+            }
+
+#pragma omp critical
+            stats += local.stats;
+        }
+
+        return minSad;
+    }
+
+    inline void recordStats(const SearchOptions &options, const SearchStats &stats)
+    {
+        if (options.stats != nullptr)
+        {
+            *options.stats += stats;
+        }
+    }
+
+    // Miglior serie (SAD minimo, a parità l'indice più basso) come riduzione OpenMP
+    struct BestSeries
+    {
+        double sad;
+        size_t index;
+    };
+
+    inline BestSeries betterSeries(const BestSeries &a, const BestSeries &b)
+    {
+        return (a.sad < b.sad || (a.sad == b.sad && a.index < b.index)) ? a : b;
+    }
+
+#pragma omp declare reduction(bestSeries : BestSeries : omp_out = betterSeries(omp_out, omp_in)) \
+    initializer(omp_priv = BestSeries{std::numeric_limits<double>::max(), std::numeric_limits<size_t>::max()})
+
+    // Blocco di offset [begin, end) di una serie
+    struct WorkChunk
+    {
+        size_t series;
+        size_t begin;
+        size_t end;
+    };
+
+    // Stato condiviso delle ricerche a blocchi (collapsed e tasks): lista di
+    // lavoro, minimo di ogni blocco, contatori e tempo di lavoro per thread
+    template <typename Dataset>
+    struct ChunkedSearch
+    {
+        // Ogni serie è divisa in blocchi di circa chunkOffsets offset, così poche
+        // serie lunghe e molte serie corte danno lo stesso numero di blocchi
+        ChunkedSearch(const Dataset &dataset, const TimeSeries &query, const SearchOptions &options,
+                      size_t chunksPerThread, size_t minChunk)
+            : dataset(dataset), context(query, options), numSeries(dataset.getNumSeries()),
+              numThreads(omp_get_max_threads()), threadStats(numThreads), threadBusyMs(numThreads, 0.0),
+              globalBest(std::numeric_limits<double>::max())
+        {
+            size_t queryLength = context.queryLength;
+            for (size_t i = 0; i < numSeries; ++i)
+            {
+                totalOffsets += numOffsets(dataset.getSeriesLength(i), queryLength);
+            }
+            chunkOffsets = std::max(minChunk, totalOffsets / (numThreads * chunksPerThread));
+
+            firstChunk.assign(numSeries + 1, 0);
+            for (size_t i = 0; i < numSeries; ++i)
+            {
+                size_t offsets = numOffsets(dataset.getSeriesLength(i), queryLength);
+                size_t pieces = (offsets + chunkOffsets - 1) / chunkOffsets;
+                for (size_t p = 0; p < pieces; ++p)
+                {
+                    chunks.push_back({i, offsets * p / pieces, offsets * (p + 1) / pieces});
+                }
+                firstChunk[i + 1] = chunks.size();
+            }
+            chunkMin.resize(chunks.size());
+
+            // Soglie di early abandon: minimo corrente di ogni serie, oppure il
+            // miglior SAD globale con shareGlobalBest (come nelle varianti outer)
+            seriesBest = std::vector<std::atomic<double>>(options.shareGlobalBest ? 0 : numSeries);
+            for (std::atomic<double> &best : seriesBest)
+            {
+                best.store(std::numeric_limits<double>::max(), std::memory_order_relaxed);
+            }
+        }
+
+        // Costo stimato di un blocco: copia dei campioni più i termini della distanza
+        size_t chunkCost(const WorkChunk &chunk) const
+        {
+            size_t count = chunk.end - chunk.begin;
+            return count * (context.queryLength + 1) + context.queryLength - 1;
+        }
+
+        void searchChunk(size_t c, ThreadState &state)
+        {
+            const WorkChunk &chunk = chunks[c];
+            size_t count = chunk.end - chunk.begin;
+
+            // Solo i campioni del blocco (più le code delle finestre)
+            auto series = dataset.getSeries(chunk.series).slice(chunk.begin, count + context.queryLength - 1);
+            const double *seriesData = contiguousValues(series, state.values);
+            state.stats.totalTerms += count * context.queryLength;
+            if (chunk.begin == 0)
+            {
+                state.stats.seriesTotal++;
+            }
+
+            std::atomic<double> *sharedBest = context.options.shareGlobalBest ? &globalBest : &seriesBest[chunk.series];
+            chunkMin[c] = seriesMinSad(context, seriesData, count, sharedBest, state);
+        }
+
+        double seriesMin(size_t i) const
+        {
+            double minSad = std::numeric_limits<double>::max();
+            for (size_t c = firstChunk[i]; c < firstChunk[i + 1]; ++c)
+            {
+                minSad = std::min(minSad, chunkMin[c]);
+            }
+            return minSad;
+        }
+
+        void recordResults() const
+        {
+            SearchStats stats;
+            for (const SearchStats &local : threadStats)
+            {
+                stats += local;
+            }
+            recordStats(context.options, stats);
+
+            LoadBalance *loadBalance = context.options.loadBalance;
+            if (loadBalance != nullptr)
+            {
+                loadBalance->busyMs.resize(std::max(loadBalance->busyMs.size(), numThreads), 0.0);
+                for (size_t t = 0; t < numThreads; ++t)
+                {
+                    loadBalance->busyMs[t] += threadBusyMs[t];
+                }
+            }
+        }
+
+        const Dataset &dataset;
+        SearchContext context;
+        size_t numSeries;
+        size_t numThreads;
+        size_t totalOffsets = 0;
+        size_t chunkOffsets = 0;
+        std::vector<WorkChunk> chunks;
+        std::vector<size_t> firstChunk; // primo blocco di ogni serie, per la riduzione per serie
+        std::vector<double> chunkMin;
+        std::vector<SearchStats> threadStats;
+        std::vector<double> threadBusyMs;
+        std::vector<std::atomic<double>> seriesBest;
+        std::atomic<double> globalBest;
+    };
+
+    template <typename Dataset>
+    std::pair<std::vector<double>, size_t> collapsedSearch(const Dataset &dataset, const TimeSeries &query,
+                                                           const SearchOptions &options)
+    {
+        ChunkedSearch<Dataset> search(dataset, query, options, COLLAPSED_CHUNKS_PER_THREAD, COLLAPSED_MIN_CHUNK);
+        size_t numSeries = search.numSeries;
+        size_t numChunks = search.chunks.size();
+
+        // Serie corte: più blocchi per richiesta allo scheduler
+        size_t grain = std::max<size_t>(1, search.chunkOffsets * numChunks / std::max<size_t>(1, search.totalOffsets));
+
+        std::vector<double> sadValues(numSeries, std::numeric_limits<double>::max());
+        BestSeries best{std::numeric_limits<double>::max(), std::numeric_limits<size_t>::max()};
+
+#pragma omp parallel
+        {
+            ThreadState state;
+            double busy = 0.0;
+
+#pragma omp for schedule(dynamic, grain)
+            for (size_t c = 0; c < numChunks; ++c)
+            {
+                double start = omp_get_wtime();
+                search.searchChunk(c, state);
+                busy += omp_get_wtime() - start;
+            }
+
+            search.threadStats[omp_get_thread_num()] = state.stats;
+            search.threadBusyMs[omp_get_thread_num()] = busy * 1000.0;
+
+            // Barriera implicita del for precedente: tutti i blocchi sono pronti
+#pragma omp for schedule(static) reduction(bestSeries : best)
+            for (size_t i = 0; i < numSeries; ++i)
+            {
+                sadValues[i] = search.seriesMin(i);
+                best = betterSeries(best, {sadValues[i], i});
+            }
+        }
+
+        search.recordResults();
+        return {std::move(sadValues), numSeries > 0 ? best.index : 0};
+    }
+
+    // Gruppo di blocchi consecutivi eseguito come un solo task
+    struct WorkTask
+    {
+        size_t firstChunk;
+        size_t lastChunk;
+        size_t cost;
+    };
+
+    template <typename Dataset>
+    std::pair<std::vector<double>, size_t> taskSearch(const Dataset &dataset, const TimeSeries &query,
+                                                      const SearchOptions &options)
+    {
+        ChunkedSearch<Dataset> search(dataset, query, options, TASKS_PER_THREAD, COLLAPSED_MIN_CHUNK);
+        size_t numSeries = search.numSeries;
+
+        // Le serie lunghe sono già divise in blocchi; quelle corte vengono
+        // raggruppate finché il costo non raggiunge quello di un blocco pieno
+        size_t targetCost = search.chunkCost({0, 0, search.chunkOffsets});
+        std::vector<WorkTask> tasks;
+        for (size_t c = 0; c < search.chunks.size(); ++c)
+        {
+            size_t cost = search.chunkCost(search.chunks[c]);
+            if (!tasks.empty() && tasks.back().lastChunk == c && tasks.back().cost + cost <= targetCost)
+            {
+                tasks.back().lastChunk = c + 1;
+                tasks.back().cost += cost;
+            }
+            else
+            {
+                tasks.push_back({c, c + 1, cost});
+            }
+        }
+
+        // Prima i task più costosi (LPT): la coda finale è fatta di task piccoli
+        // che i thread liberi si contendono, invece di un blocco lungo isolato
+        std::stable_sort(tasks.begin(), tasks.end(),
+                         [](const WorkTask &a, const WorkTask &b) { return a.cost > b.cost; });
+
+        std::vector<ThreadState> states(search.numThreads);
+        std::vector<double> sadValues(numSeries, std::numeric_limits<double>::max());
+        BestSeries best{std::numeric_limits<double>::max(), std::numeric_limits<size_t>::max()};
+
+#pragma omp parallel
+        {
+            // Un thread crea i task, tutti (anche il produttore, a fine single)
+            // li eseguono; il runtime ridistribuisce i task tra i thread liberi
+#pragma omp single
+            {
+                for (const WorkTask &task : tasks)
+                {
+#pragma omp task firstprivate(task) shared(search, states)
+                    {
+                        size_t thread = omp_get_thread_num();
+                        double start = omp_get_wtime();
+                        for (size_t c = task.firstChunk; c < task.lastChunk; ++c)
+                        {
+                            search.searchChunk(c, states[thread]);
+                        }
+                        search.threadBusyMs[thread] += (omp_get_wtime() - start) * 1000.0;
+                    }
+                }
+            }
+
+            // Barriera implicita del single: tutti i task sono completati
+#pragma omp for schedule(static) reduction(bestSeries : best)
+            for (size_t i = 0; i < numSeries; ++i)
+            {
+                sadValues[i] = search.seriesMin(i);
+                best = betterSeries(best, {sadValues[i], i});
+            }
+        }
+
+        for (size_t t = 0; t < search.numThreads; ++t)
+        {
+            search.threadStats[t] = states[t].stats;
+        }
+
+        search.recordResults();
+        return {std::move(sadValues), numSeries > 0 ? best.index : 0};
+    }
+
+    // Offset di una serie che iniziano nello stesso blocco dell'indice, con il
+    // lower bound della loro SAD
+    struct IndexedBlock
+    {
+        double bound;
+        WorkChunk chunk;
+    };
+
+    template <typename Dataset>
+    std::pair<std::vector<double>, size_t> indexedSearch(const DatasetIndex &index, const Dataset &dataset,
+                                                         const TimeSeries &query, const SearchOptions &options)
+    {
+        size_t numSeries = dataset.getNumSeries();
+        SearchContext context(query, options);
+        size_t queryLength = context.queryLength;
+        size_t blockLength = index.getBlockLength();
+
+        std::vector<size_t> firstBlock(numSeries + 1, 0);
+        for (size_t i = 0; i < numSeries; ++i)
+        {
+            size_t offsets = numOffsets(dataset.getSeriesLength(i), queryLength);
+            firstBlock[i + 1] = firstBlock[i] + (offsets + blockLength - 1) / blockLength;
+        }
+        std::vector<IndexedBlock> blocks(firstBlock.back());
+
+#pragma omp parallel for schedule(dynamic)
+        for (size_t i = 0; i < numSeries; ++i)
+        {
+            size_t offsets = numOffsets(dataset.getSeriesLength(i), queryLength);
+            for (size_t b = 0; b < firstBlock[i + 1] - firstBlock[i]; ++b)
+            {
+                size_t begin = b * blockLength;
+                blocks[firstBlock[i] + b] = {index.blockBound(i, b, context.queryData, queryLength),
+                                             {i, begin, std::min(begin + blockLength, offsets)}};
+            }
+        }
+
+        // Prima i blocchi più promettenti: il miglior SAD scende subito e i
+        // blocchi con lower bound maggiore vengono scartati senza leggerne i dati
+        std::sort(blocks.begin(), blocks.end(), [](const IndexedBlock &a, const IndexedBlock &b)
+                  { return a.bound < b.bound ||
+                           (a.bound == b.bound && (a.chunk.series < b.chunk.series ||
+                                                   (a.chunk.series == b.chunk.series && a.chunk.begin < b.chunk.begin))); });
+
+        std::vector<std::atomic<double>> seriesBest(numSeries);
+        for (std::atomic<double> &best : seriesBest)
+        {
+            best.store(std::numeric_limits<double>::max(), std::memory_order_relaxed);
+        }
+        std::atomic<double> globalBest(std::numeric_limits<double>::max());
+        std::vector<ThreadState> states(omp_get_max_threads());
+
+#pragma omp parallel for schedule(dynamic)
+        for (size_t c = 0; c < blocks.size(); ++c)
+        {
+            ThreadState &state = states[omp_get_thread_num()];
+            const WorkChunk &chunk = blocks[c].chunk;
+            size_t count = chunk.end - chunk.begin;
+            state.stats.totalTerms += count * queryLength;
+            if (chunk.begin == 0)
+            {
+                state.stats.seriesTotal++;
+            }
+
+            // A parità di bound il blocco viene calcolato: i pari merito del
+            // best match restano tra i risultati
+            if (blocks[c].bound > globalBest.load(std::memory_order_relaxed))
+            {
+                state.stats.windowsPrunedIndex += count;
+                continue;
+            }
+
+            auto series = dataset.getSeries(chunk.series).slice(chunk.begin, count + queryLength - 1);
+            const double *seriesData = contiguousValues(series, state.values);
+            std::atomic<double> *sharedBest = options.shareGlobalBest ? &globalBest : &seriesBest[chunk.series];
+            double sad = seriesMinSad(context, seriesData, count, sharedBest, state);
+            publishBest(seriesBest[chunk.series], sad);
+            publishBest(globalBest, sad);
+        }
+
+        // Serie scartate interamente: max(); le altre hanno il minimo dei blocchi calcolati
+        std::vector<double> sadValues(numSeries);
+        size_t bestIndex = 0;
+        for (size_t i = 0; i < numSeries; ++i)
+        {
+            sadValues[i] = seriesBest[i].load(std::memory_order_relaxed);
+            if (sadValues[i] < sadValues[bestIndex])
+                bestIndex = i;
+        }
+
+        SearchStats stats;
+        for (const ThreadState &state : states)
+        {
+            stats += state.stats;
+        }
+        recordStats(options, stats);
+        return {std::move(sadValues), bestIndex};
+    }
+
+    // Medie di blocchi consecutivi di factor campioni (il resto finale è scartato)
+    inline void downsample(const double *values, size_t length, size_t factor, AlignedVector<double> &out)
+    {
+        out.resize(length / factor);
+        for (size_t b = 0; b < out.size(); ++b)
+        {
+            double sum = 0.0;
+            for (size_t t = 0; t < factor; ++t)
+            {
+                sum += values[b * factor + t];
+            }
+            out[b] = sum / factor;
+        }
+    }
+
+    // Ricerca approssimata. Fase 1: serie e query ridotte di un fattore stride
+    // (medie a blocchi), distanze di tutte le finestre ridotte con il kernel
+    // usuale: costo ~ 1 / stride^2 della ricerca esatta. Ogni candidato p
+    // corrisponde all'offset p * stride, di cui si calcola la SAD esatta.
+    // Fase 2: offset entro stride - 1 dai candidati, per le serie migliori
+    template <typename Dataset>
+    std::pair<std::vector<double>, size_t> approximateSearch(const Dataset &dataset, const TimeSeries &query,
+                                                             const ApproximateOptions &approximate,
+                                                             const SearchOptions &options)
+    {
+        double start = omp_get_wtime();
+        size_t numSeries = dataset.getNumSeries();
+        SearchContext context(query, options);
+        size_t queryLength = context.queryLength;
+        size_t stride = std::min(std::max<size_t>(approximate.stride, 1), std::max<size_t>(queryLength, 1));
+        size_t numCandidates = std::max<size_t>(approximate.refineCandidates, 1);
+
+        AlignedVector<double> reducedQuery;
+        downsample(context.queryData, queryLength, stride, reducedQuery);
+        size_t reducedLength = reducedQuery.size();
+
+        std::vector<double> sadValues(numSeries, std::numeric_limits<double>::max());
+        std::vector<size_t> candidates(numSeries * numCandidates, std::numeric_limits<size_t>::max());
+        std::vector<ThreadState> states(omp_get_max_threads());
+
+#pragma omp parallel
+        {
+            ThreadState &state = states[omp_get_thread_num()];
+            AlignedVector<double> reduced;
+            AlignedVector<double> distances;
+            std::vector<double> candidateDistance(numCandidates);
+
+#pragma omp for schedule(dynamic)
+            for (size_t i = 0; i < numSeries; ++i)
+            {
+                auto series = dataset.getSeries(i);
+                size_t offsets = numOffsets(series.size(), queryLength);
+                if (offsets == 0 || reducedLength == 0)
+                    continue;
+
+                state.stats.totalTerms += offsets * queryLength;
+                state.stats.seriesTotal++;
+
+                const double *seriesData = contiguousValues(series, state.values);
+                downsample(seriesData, series.size(), stride, reduced);
+                size_t reducedOffsets = std::min(numOffsets(reduced.size(), reducedLength), (offsets - 1) / stride + 1);
+                distances.resize(reducedOffsets);
+                context.kernel.slidingSad(reduced.data(), reducedQuery.data(), reducedLength, reducedOffsets,
+                                          distances.data());
+                state.stats.evaluatedTerms += reducedOffsets * reducedLength;
+
+                // I numCandidates migliori, a parità l'offset più basso
+                size_t *best = candidates.data() + i * numCandidates;
+                std::fill(candidateDistance.begin(), candidateDistance.end(), std::numeric_limits<double>::max());
+                for (size_t p = 0; p < reducedOffsets; ++p)
+                {
+                    size_t slot = numCandidates;
+                    while (slot > 0 && distances[p] < candidateDistance[slot - 1])
+                    {
+                        --slot;
+                    }
+                    if (slot == numCandidates)
+                        continue;
+
+                    for (size_t c = numCandidates - 1; c > slot; --c)
+                    {
+                        candidateDistance[c] = candidateDistance[c - 1];
+                        best[c] = best[c - 1];
+                    }
+                    candidateDistance[slot] = distances[p];
+                    best[slot] = p * stride;
+                }
+
+                sadValues[i] = context.kernel.minSad(seriesData + best[0], context.queryData, queryLength, 1);
+                state.stats.evaluatedTerms += queryLength;
+            }
+        }
+
+        // Fase 2: dalla serie con la SAD esatta più bassa, finché il budget lo consente
+        size_t refineSeries = std::max(approximate.minRefineSeries,
+                                       static_cast<size_t>(std::ceil(approximate.refineFraction * numSeries)));
+        std::vector<size_t> order(numSeries);
+        std::iota(order.begin(), order.end(), 0);
+        refineSeries = std::min(refineSeries, numSeries);
+        std::partial_sort(order.begin(), order.begin() + refineSeries, order.end(), [&](size_t a, size_t b)
+                          { return sadValues[a] < sadValues[b] || (sadValues[a] == sadValues[b] && a < b); });
+
+#pragma omp parallel for schedule(dynamic)
+        for (size_t r = 0; r < refineSeries; ++r)
+        {
+            if (approximate.timeBudgetMs > 0.0 && (omp_get_wtime() - start) * 1000.0 > approximate.timeBudgetMs)
+                continue;
+
+            ThreadState &state = states[omp_get_thread_num()];
+            size_t i = order[r];
+            size_t offsets = numOffsets(dataset.getSeriesLength(i), queryLength);
+            if (offsets == 0 || stride == 1)
+                continue;
+
+            for (size_t c = 0; c < numCandidates; ++c)
+            {
+                size_t center = candidates[i * numCandidates + c];
+                if (center == std::numeric_limits<size_t>::max())
+                    break;
+
+                size_t begin = center >= stride - 1 ? center - (stride - 1) : 0;
+                size_t end = std::min(center + stride, offsets);
+                auto window = dataset.getSeries(i).slice(begin, end - begin + queryLength - 1);
+                const double *seriesData = contiguousValues(window, state.values);
+                sadValues[i] = std::min(sadValues[i], rangeMinSad(context, seriesData, end - begin, sadValues[i], state));
+            }
+            state.stats.seriesRefined++;
+        }
+
+        size_t bestIndex = 0;
+        for (size_t i = 1; i < numSeries; ++i)
+        {
+            if (sadValues[i] < sadValues[bestIndex])
+                bestIndex = i;
+        }
+
+        SearchStats stats;
+        for (const ThreadState &state : states)
+        {
+            stats += state.stats;
+        }
+        recordStats(options, stats);
+        return {std::move(sadValues), bestIndex};
+    }
+
+    template <typename Dataset>
+    std::vector<std::pair<std::vector<double>, size_t>> batchSearch(const Dataset &dataset,
+                                                                     const std::vector<TimeSeries> &queries,
+                                                                     const SearchOptions &options)
+    {
+        size_t numSeries = dataset.getNumSeries();
+        size_t numQueries = queries.size();
+
+        std::vector<SearchContext> contexts;
+        contexts.reserve(numQueries);
+        for (const TimeSeries &query : queries)
+        {
+            contexts.emplace_back(query, options);
+        }
+
+        std::vector<std::pair<std::vector<double>, size_t>> results(numQueries);
+        for (auto &result : results)
+        {
+            result.first.assign(numSeries, std::numeric_limits<double>::max());
+            result.second = 0;
+        }
+
+        // Confini dei blocchi: serie consecutive fino a BATCH_TILE_BYTES (almeno una)
+        std::vector<size_t> tileStarts;
+        for (size_t i = 0; i < numSeries;)
+        {
+            tileStarts.push_back(i);
+            size_t bytes = dataset.getSeriesLength(i++) * sizeof(double);
+            while (i < numSeries && bytes + dataset.getSeriesLength(i) * sizeof(double) <= BATCH_TILE_BYTES)
+            {
+                bytes += dataset.getSeriesLength(i++) * sizeof(double);
+            }
+        }
+        tileStarts.push_back(numSeries);
+        size_t numTiles = tileStarts.size() - 1;
+        SearchStats stats;
+
+#pragma omp parallel
+        {
+            ThreadState state;
+            AlignedVector<double> tile;
+            std::vector<const double *> tileSeries;
+
+#pragma omp for schedule(dynamic)
+            for (size_t t = 0; t < numTiles; ++t)
+            {
+                size_t first = tileStarts[t];
+                size_t last = tileStarts[t + 1];
 
-    for (size_t i = 0; i < dataset.getNumSeries(); ++i)
+                // Le serie con stride vengono raccolte una sola volta per tutte le query
+                size_t tileLength = 0;
+                for (size_t i = first; i < last; ++i)
+                {
+                    tileLength += dataset.getSeriesLength(i);
+                }
+                tile.resize(tileLength);
+                tileSeries.clear();
+
+                double *cursor = tile.data();
+                for (size_t i = first; i < last; ++i)
+                {
+                    auto series = dataset.getSeries(i);
+                    if (series.isContiguous())
+                    {
+                        tileSeries.push_back(reinterpret_cast<const double *>(series.data()));
+                        continue;
+                    }
+
+                    for (size_t x = 0; x < series.size(); ++x)
+                    {
+                        cursor[x] = series[x];
+                    }
+                    tileSeries.push_back(cursor);
+                    cursor += series.size();
+                }
+
+                for (size_t q = 0; q < numQueries; ++q)
+                {
+                    const SearchContext &context = contexts[q];
+                    std::vector<double> &sadValues = results[q].first;
+
+                    for (size_t i = first; i < last; ++i)
+                    {
+                        size_t offsets = numOffsets(dataset.getSeriesLength(i), context.queryLength);
+                        if (offsets == 0)
+                            continue;
+
+                        state.stats.totalTerms += offsets * context.queryLength;
+                        state.stats.seriesTotal++;
+                        // Stesso motore delle ricerche singole (FFT per le serie lunghe)
+                        sadValues[i] = seriesMinSad(context, tileSeries[i - first], offsets, nullptr, state);
+                    }
+                }
+            }
+
+#pragma omp critical
+            stats += state.stats;
+        }
+
+        // Best match per query: primo indice con il SAD minimo, come nelle ricerche singole
+        for (auto &result : results)
+        {
+            const std::vector<double> &sadValues = result.first;
+            for (size_t i = 1; i < numSeries; ++i)
+            {
+                if (sadValues[i] < sadValues[result.second])
+                {
+                    result.second = i;
+                }
+            }
+        }
+
+        recordStats(options, stats);
+        return results;
+    }
+
+    // Inserisce nell'heap le finestre di una serie che possono entrare nei top-K.
+    // sharedKth (se non nullo) è il minimo tra i K-esimi degli heap dei thread:
+    // ogni heap contiene K finestre distinte, quindi è un limite superiore del
+    // K-esimo globale e può essere usato come soglia da tutti
+    template <typename T>
+    void searchSeriesTopK(const SearchContext &context, const SeriesView<T> &series, size_t seriesIndex,
+                          TopKHeap &heap, std::atomic<double> *sharedKth, ThreadState &state)
     {
-        size_t seriesLength = dataset.getSeriesLength(i);
-        double minSad = std::numeric_limits<double>::max();
+        size_t offsets = numOffsets(series.size(), context.queryLength);
+        if (offsets == 0 || heap.capacity() == 0)
+            return;
+
+        const double *seriesData = contiguousValues(series, state.values);
+        state.stats.totalTerms += offsets * context.queryLength;
+        state.stats.seriesTotal++;
+
+        double buffer[TOPK_CHUNK];
+
+        for (size_t j = 0; j < offsets; j += TOPK_CHUNK)
+        {
+            size_t count = std::min(TOPK_CHUNK, offsets - j);
+            double threshold = heap.threshold();
+            if (sharedKth != nullptr)
+            {
+                threshold = std::min(threshold, sharedKth->load(std::memory_order_relaxed));
+            }
+
+            context.kernel.slidingSadEarlyAbandon(seriesData + j, context.queryData, context.queryLength,
+                                                  count, threshold, buffer, &state.stats.evaluatedTerms);
+
+            for (size_t o = 0; o < count; ++o)
+            {
+                if (buffer[o] <= threshold)
+                {
+                    heap.push({seriesIndex, j + o, buffer[o]});
+                }
+            }
+
+            if (sharedKth != nullptr && heap.full())
+            {
+                publishBest(*sharedKth, heap.threshold());
+            }
+        }
+    }
+
+    template <typename Dataset>
+    std::vector<Match> topKOuter(const Dataset &dataset, const TimeSeries &query, size_t k,
+                                 const SearchOptions &options)
+    {
+        size_t numSeries = dataset.getNumSeries();
+        SearchContext context(query, options);
 
-        for (size_t j = 0; j <= seriesLength - queryLength; ++j)
+        TopKHeap result(k);
+        std::atomic<double> globalKth(std::numeric_limits<double>::max());
+        std::atomic<double> *sharedKth = options.shareGlobalBest ? &globalKth : nullptr;
+        SearchStats stats;
+
+#pragma omp parallel
         {
-            double sad = 0.0;
+            TopKHeap heap(k);
+            ThreadState state;
 
-            for (size_t k = 0; k < queryLength; ++k)
+#pragma omp for schedule(dynamic)
+            for (size_t i = 0; i < numSeries; ++i)
             {
-                double seriesValue = dataset.getValue(i, j + k);
-                sad += std::abs(seriesValue - queryData[k]);
+                searchSeriesTopK(context, dataset.getSeries(i), i, heap, sharedKth, state);
             }
 
-            if (sad < minSad)
+            // Merge degli heap locali: al più K inserimenti per thread
+#pragma omp critical
             {
-                minSad = sad;
+                result.merge(heap);
+                stats += state.stats;
             }
         }
 
-        sadValues[i] = minSad;
+        recordStats(options, stats);
+        return result.sorted();
+    }
 
-        if (minSad < bestSad)
+    template <typename Dataset>
+    std::vector<std::vector<Match>> topKPerSeries(const Dataset &dataset, const TimeSeries &query, size_t k,
+                                                  const SearchOptions &options)
+    {
+        size_t numSeries = dataset.getNumSeries();
+        SearchContext context(query, options);
+
+        std::vector<std::vector<Match>> matches(numSeries);
+        SearchStats stats;
+
+#pragma omp parallel
         {
-            bestSad = minSad;
-            bestIndex = i;
+            TopKHeap heap(k);
+            ThreadState state;
+
+#pragma omp for schedule(dynamic)
+            for (size_t i = 0; i < numSeries; ++i)
+            {
+                heap.clear();
+                searchSeriesTopK(context, dataset.getSeries(i), i, heap, nullptr, state);
+                matches[i] = heap.sorted();
+            }
+
+#pragma omp critical
+            stats += state.stats;
         }
+
+        recordStats(options, stats);
+        return matches;
     }
 
-    return {sadValues, bestIndex};
 }
 
-std::pair<std::vector<double>, size_t> SearchEngine::searchSequentialAoS(const TimeSeriesAoS &dataset, const TimeSeries &query)
+std::pair<std::vector<double>, size_t> SearchEngine::searchSequentialSoA(const TimeSeriesSoA &dataset, const TimeSeries &query, const SearchOptions &options)
 {
     std::vector<double> sadValues(dataset.getNumSeries(), std::numeric_limits<double>::max());
-    size_t queryLength = query.getSize();
     size_t bestIndex = 0;
     double bestSad = std::numeric_limits<double>::max();
-    const std::vector<double> &queryData = query.getData();
+    SearchContext context(query, options);
+    ThreadState state;
 
     for (size_t i = 0; i < dataset.getNumSeries(); ++i)
     {
-        const std::vector<double> &seriesData = dataset.getSeries(i);
-        size_t seriesLength = seriesData.size();
-        double minSad = std::numeric_limits<double>::max();
+        double minSad = searchSeries(context, dataset.getSeries(i), nullptr, state);
 
-        for (size_t j = 0; j <= seriesLength - queryLength; ++j)
+        sadValues[i] = minSad;
+
+        if (minSad < bestSad)
         {
-            double sad = 0.0;
+            bestSad = minSad;
+            bestIndex = i;
+        }
+    }
 
-            for (size_t k = 0; k < queryLength; ++k)
-            {
-                sad += std::abs(seriesData[j + k] - queryData[k]);
-            }
+    recordStats(options, state.stats);
+    return {std::move(sadValues), bestIndex};
+}
 
-            if (sad < minSad)
-            {
-                minSad = sad;
-            }
-        }
+std::pair<std::vector<double>, size_t> SearchEngine::searchSequentialAoS(const TimeSeriesAoS &dataset, const TimeSeries &query, const SearchOptions &options)
+{
+    std::vector<double> sadValues(dataset.getNumSeries(), std::numeric_limits<double>::max());
+    size_t bestIndex = 0;
+    double bestSad = std::numeric_limits<double>::max();
+    SearchContext context(query, options);
+    ThreadState state;
+
+    for (size_t i = 0; i < dataset.getNumSeries(); ++i)
+    {
+        double minSad = searchSeries(context, dataset.getSeries(i), nullptr, state);
 
         sadValues[i] = minSad;
 
@@ -81,47 +1019,32 @@ std::pair<std::vector<double>, size_t> SearchEngine::searchSequentialAoS(const T
         }
     }
 
-    return {sadValues, bestIndex};
+    recordStats(options, state.stats);
+    return {std::move(sadValues), bestIndex};
 }
 
-std::pair<std::vector<double>, size_t> SearchEngine::searchParallelAoSOuter(const TimeSeriesAoS &dataset, const TimeSeries &query)
+std::pair<std::vector<double>, size_t> SearchEngine::searchParallelAoSOuter(const TimeSeriesAoS &dataset, const TimeSeries &query, const SearchOptions &options)
 {
     size_t numSeries = dataset.getNumSeries();
-    size_t queryLength = query.getSize();
-    const auto &queryData = query.getData();
+    SearchContext context(query, options);
 
     std::vector<double> sadValues(numSeries, std::numeric_limits<double>::max());
     size_t bestIndex = 0;
     double bestSad = std::numeric_limits<double>::max();
+    std::atomic<double> globalBest(std::numeric_limits<double>::max());
+    std::atomic<double> *sharedBest = options.shareGlobalBest ? &globalBest : nullptr;
+    SearchStats stats;
 
 #pragma omp parallel
     {
         double localBestSad = std::numeric_limits<double>::max();
         size_t localBestIndex = 0;
+        ThreadState state;
 
 #pragma omp for schedule(dynamic)
         for (size_t i = 0; i < numSeries; ++i)
         {
-            const std::vector<double> &seriesData = dataset.getSeries(i);
-            size_t seriesLength = seriesData.size();
-
-            double minSad = std::numeric_limits<double>::max();
-
-            for (size_t j = 0; j <= seriesLength - queryLength; ++j)
-            {
-                double sad = 0.0;
-
-#pragma omp simd reduction(+ : sad)
-                for (size_t k = 0; k < queryLength; ++k)
-                {
-                    sad += std::abs(seriesData[j + k] - queryData[k]);
-                }
-
-                if (sad < minSad)
-                {
-                    minSad = sad;
-                }
-            }
+            double minSad = searchSeries(context, dataset.getSeries(i), sharedBest, state);
 
             sadValues[i] = minSad;
 
@@ -134,22 +1057,24 @@ std::pair<std::vector<double>, size_t> SearchEngine::searchParallelAoSOuter(cons
 
 #pragma omp critical
         {
-            if (localBestSad < bestSad)
+            if (localBestSad < bestSad || (localBestSad == bestSad && localBestIndex < bestIndex))
             {
                 bestSad = localBestSad;
                 bestIndex = localBestIndex;
             }
+            stats += state.stats;
         }
     }
 
-    return {sadValues, bestIndex};
+    recordStats(options, stats);
+    return {std::move(sadValues), bestIndex};
 }
 
-std::pair<std::vector<double>, size_t> SearchEngine::searchParallelAoSInner(const TimeSeriesAoS &dataset, const TimeSeries &query)
+std::pair<std::vector<double>, size_t> SearchEngine::searchParallelAoSInner(const TimeSeriesAoS &dataset, const TimeSeries &query, const SearchOptions &options)
 {
     size_t numSeries = dataset.getNumSeries();
-    size_t queryLength = query.getSize();
-    const auto &queryData = query.getData();
+    SearchContext context(query, options);
+    ThreadState state;
 
     std::vector<double> sadValues(numSeries, std::numeric_limits<double>::max());
     size_t bestIndex = 0;
@@ -158,29 +1083,9 @@ std::pair<std::vector<double>, size_t> SearchEngine::searchParallelAoSInner(cons
     // Loop sequenziale sulle serie
     for (size_t i = 0; i < numSeries; ++i)
     {
-        const std::vector<double> &seriesData = dataset.getSeries(i);
-        size_t seriesLength = seriesData.size();
-
-        double minSad = std::numeric_limits<double>::max();
-
-        // Parallelizzazione sulle posizioni nella serie
-#pragma omp parallel for reduction(min : minSad) schedule(static)
-        for (size_t j = 0; j <= seriesLength - queryLength; ++j)
-        {
-            double sad = 0.0;
-
-            // Vettorizzazione del calcolo SAD
-#pragma omp simd reduction(+ : sad)
-            for (size_t k = 0; k < queryLength; ++k)
-            {
-                sad += std::abs(seriesData[j + k] - queryData[k]);
-            }
-
-            if (sad < minSad)
-            {
-                minSad = sad;
-            }
-        }
+        // Parallelizzazione sulle posizioni nella serie, ogni thread usa il
+        // kernel SIMD sul proprio blocco di offset
+        double minSad = parallelSearchSeries(context, dataset.getSeries(i), state);
 
         sadValues[i] = minSad;
 
@@ -191,49 +1096,33 @@ std::pair<std::vector<double>, size_t> SearchEngine::searchParallelAoSInner(cons
         }
     }
 
-    return {sadValues, bestIndex};
+    recordStats(options, state.stats);
+    return {std::move(sadValues), bestIndex};
 }
 
-std::pair<std::vector<double>, size_t> SearchEngine::searchParallelSoAOuter(const TimeSeriesSoA &dataset, const TimeSeries &query)
+std::pair<std::vector<double>, size_t> SearchEngine::searchParallelSoAOuter(const TimeSeriesSoA &dataset, const TimeSeries &query, const SearchOptions &options)
 {
     size_t numSeries = dataset.getNumSeries();
-    size_t queryLength = query.getSize();
-    const auto &queryData = query.getData();
+    SearchContext context(query, options);
 
     std::vector<double> sadValues(numSeries, std::numeric_limits<double>::max());
     size_t bestIndex = 0;
     double bestSad = std::numeric_limits<double>::max();
+    std::atomic<double> globalBest(std::numeric_limits<double>::max());
+    std::atomic<double> *sharedBest = options.shareGlobalBest ? &globalBest : nullptr;
+    SearchStats stats;
 
 #pragma omp parallel
     {
         double localBestSad = std::numeric_limits<double>::max();
         size_t localBestIndex = 0;
+        ThreadState state;
 
 #pragma omp for schedule(dynamic)
         for (size_t i = 0; i < numSeries; ++i)
         {
-            size_t seriesLength = dataset.getSeriesLength(i);
-
-            double minSad = std::numeric_limits<double>::max();
-
-            // Loop sequenziale sulle posizioni
-            for (size_t j = 0; j <= seriesLength - queryLength; ++j)
-            {
-                double sad = 0.0;
-
-                // Calcolo SAD con accesso SoA
-#pragma omp simd reduction(+ : sad)
-                for (size_t k = 0; k < queryLength; ++k)
-                {
-                    double seriesValue = dataset.getValue(i, j + k);
-                    sad += std::abs(seriesValue - queryData[k]);
-                }
-
-                if (sad < minSad)
-                {
-                    minSad = sad;
-                }
-            }
+            // Accesso SoA: la serie viene resa contigua una volta sola
+            double minSad = searchSeries(context, dataset.getSeries(i), sharedBest, state);
 
             sadValues[i] = minSad;
 
@@ -246,22 +1135,24 @@ std::pair<std::vector<double>, size_t> SearchEngine::searchParallelSoAOuter(cons
 
 #pragma omp critical
         {
-            if (localBestSad < bestSad)
+            if (localBestSad < bestSad || (localBestSad == bestSad && localBestIndex < bestIndex))
             {
                 bestSad = localBestSad;
                 bestIndex = localBestIndex;
             }
+            stats += state.stats;
         }
     }
 
-    return {sadValues, bestIndex};
+    recordStats(options, stats);
+    return {std::move(sadValues), bestIndex};
 }
 
-std::pair<std::vector<double>, size_t> SearchEngine::searchParallelSoAInner(const TimeSeriesSoA &dataset, const TimeSeries &query)
+std::pair<std::vector<double>, size_t> SearchEngine::searchParallelSoAInner(const TimeSeriesSoA &dataset, const TimeSeries &query, const SearchOptions &options)
 {
     size_t numSeries = dataset.getNumSeries();
-    size_t queryLength = query.getSize();
-    const auto &queryData = query.getData();
+    SearchContext context(query, options);
+    ThreadState state;
 
     std::vector<double> sadValues(numSeries, std::numeric_limits<double>::max());
     size_t bestIndex = 0;
@@ -269,36 +1160,270 @@ std::pair<std::vector<double>, size_t> SearchEngine::searchParallelSoAInner(cons
 
     for (size_t i = 0; i < numSeries; ++i)
     {
-        size_t seriesLength = dataset.getSeriesLength(i);
+        double minSad = parallelSearchSeries(context, dataset.getSeries(i), state);
 
-        double minSad = std::numeric_limits<double>::max();
+        sadValues[i] = minSad;
 
-#pragma omp parallel for reduction(min : minSad) schedule(static)
-        for (size_t j = 0; j <= seriesLength - queryLength; ++j)
+        if (minSad < bestSad)
         {
-            double sad = 0.0;
+            bestSad = minSad;
+            bestIndex = i;
+        }
+    }
 
-#pragma omp simd reduction(+ : sad)
-            for (size_t k = 0; k < queryLength; ++k)
-            {
-                double seriesValue = dataset.getValue(i, j + k);
-                sad += std::abs(seriesValue - queryData[k]);
-            }
+    recordStats(options, state.stats);
+    return {std::move(sadValues), bestIndex};
+}
 
-            if (sad < minSad)
+
+std::pair<std::vector<double>, size_t> SearchEngine::searchParallelSoACollapsed(const TimeSeriesSoA &dataset, const TimeSeries &query, const SearchOptions &options)
+{
+    return collapsedSearch(dataset, query, options);
+}
+
+std::pair<std::vector<double>, size_t> SearchEngine::searchParallelAoSCollapsed(const TimeSeriesAoS &dataset, const TimeSeries &query, const SearchOptions &options)
+{
+    return collapsedSearch(dataset, query, options);
+}
+
+std::pair<std::vector<double>, size_t> SearchEngine::searchParallelSoATasks(const TimeSeriesSoA &dataset, const TimeSeries &query, const SearchOptions &options)
+{
+    return taskSearch(dataset, query, options);
+}
+
+std::pair<std::vector<double>, size_t> SearchEngine::searchParallelAoSTasks(const TimeSeriesAoS &dataset, const TimeSeries &query, const SearchOptions &options)
+{
+    return taskSearch(dataset, query, options);
+}
+
+std::pair<std::vector<double>, size_t> SearchEngine::searchCompactSoA(const CompactDataset &compact, const TimeSeriesSoA &dataset, const TimeSeries &query, bool rerank, const SearchOptions &options)
+{
+    size_t numSeries = dataset.getNumSeries();
+    size_t queryLength = query.getSize();
+
+    if (options.metric != DistanceMetric::Sad || compact.getType() == ElementType::Float64 ||
+        compact.getNumSeries() != numSeries || queryLength > CompactDataset::maxQueryLength(compact.getType()))
+    {
+        return searchParallelSoAOuter(dataset, query, options);
+    }
+
+    SearchContext context(query, options);
+    std::vector<double> sadValues(numSeries, std::numeric_limits<double>::max());
+    std::vector<double> errors(numSeries, 0.0);
+    SearchStats stats;
+
+    // Stima su tutte le serie
+#pragma omp parallel
+    {
+        CompactScratch scratch;
+        SearchStats local;
+
+#pragma omp for schedule(dynamic)
+        for (size_t i = 0; i < numSeries; ++i)
+        {
+            size_t offsets = numOffsets(compact.getSeriesLength(i), queryLength);
+            CompactEstimate estimate = compact.approximateMinSad(i, context.queryData, queryLength, scratch);
+            sadValues[i] = estimate.minSad;
+            errors[i] = estimate.error;
+            local.totalTerms += offsets * queryLength;
+            local.windowsCompact += offsets;
+            local.seriesTotal++;
+        }
+
+#pragma omp critical
+        stats += local;
+    }
+
+    if (rerank)
+    {
+        // Il minimo esatto globale è <= bound; una serie con stima - errore
+        // maggiore di bound non può raggiungerlo, quindi tutte le serie che
+        // contengono il minimo (anche a pari merito) sono tra i candidati
+        double bound = std::numeric_limits<double>::max();
+        for (size_t i = 0; i < numSeries; ++i)
+        {
+            bound = std::min(bound, sadValues[i] + errors[i]);
+        }
+
+        std::vector<size_t> candidates;
+        for (size_t i = 0; i < numSeries; ++i)
+        {
+            if (sadValues[i] != std::numeric_limits<double>::max() && sadValues[i] - errors[i] <= bound)
+                candidates.push_back(i);
+        }
+
+        // Candidati in ordine di limite inferiore, a lotti: appena il limite
+        // del prossimo supera il miglior valore esatto trovato, nessuna serie
+        // rimanente può eguagliarlo (le loro stime restano approssimate)
+        std::sort(candidates.begin(), candidates.end(), [&](size_t a, size_t b)
+                  { return sadValues[a] - errors[a] < sadValues[b] - errors[b]; });
+
+        size_t batchSize = static_cast<size_t>(omp_get_max_threads()) * RERANK_BATCH_PER_THREAD;
+        double bestExact = std::numeric_limits<double>::max();
+        std::vector<ThreadState> states(omp_get_max_threads());
+
+        for (size_t first = 0; first < candidates.size(); first += batchSize)
+        {
+            size_t next = candidates[first];
+            if (sadValues[next] - errors[next] > bestExact)
+                break;
+
+            size_t last = std::min(first + batchSize, candidates.size());
+
+#pragma omp parallel for schedule(dynamic) reduction(min : bestExact)
+            for (size_t c = first; c < last; ++c)
             {
-                minSad = sad;
+                ThreadState &state = states[omp_get_thread_num()];
+                size_t i = candidates[c];
+                sadValues[i] = searchSeries(context, dataset.getSeries(i), nullptr, state);
+                state.stats.seriesReranked++;
+                bestExact = std::min(bestExact, sadValues[i]);
             }
         }
 
-        sadValues[i] = minSad;
-
-        if (minSad < bestSad)
+        // I candidati contano già come serie e termini della stima;
+        // evaluatedTerms conta solo i termini calcolati in double
+        for (ThreadState &state : states)
         {
-            bestSad = minSad;
+            state.stats.totalTerms = 0;
+            state.stats.seriesTotal = 0;
+            stats += state.stats;
+        }
+    }
+
+    size_t bestIndex = 0;
+    for (size_t i = 1; i < numSeries; ++i)
+    {
+        if (sadValues[i] < sadValues[bestIndex])
             bestIndex = i;
+    }
+
+    recordStats(options, stats);
+    return {std::move(sadValues), bestIndex};
+}
+
+std::pair<std::vector<double>, size_t> SearchEngine::searchIndexedSoA(const DatasetIndex &index, const TimeSeriesSoA &dataset, const TimeSeries &query, const SearchOptions &options)
+{
+    if (options.metric != DistanceMetric::Sad || !index.matches(dataset))
+        return searchParallelSoAOuter(dataset, query, options);
+    return indexedSearch(index, dataset, query, options);
+}
+
+std::pair<std::vector<double>, size_t> SearchEngine::searchIndexedAoS(const DatasetIndex &index, const TimeSeriesAoS &dataset, const TimeSeries &query, const SearchOptions &options)
+{
+    if (options.metric != DistanceMetric::Sad || !index.matches(dataset))
+        return searchParallelAoSOuter(dataset, query, options);
+    return indexedSearch(index, dataset, query, options);
+}
+
+std::vector<std::pair<std::vector<double>, size_t>> SearchEngine::searchBatchSoA(const TimeSeriesSoA &dataset, const std::vector<TimeSeries> &queries, const SearchOptions &options)
+{
+    return batchSearch(dataset, queries, options);
+}
+
+std::vector<std::pair<std::vector<double>, size_t>> SearchEngine::searchBatchAoS(const TimeSeriesAoS &dataset, const std::vector<TimeSeries> &queries, const SearchOptions &options)
+{
+    return batchSearch(dataset, queries, options);
+}
+
+std::vector<Match> SearchEngine::searchTopKSoA(const TimeSeriesSoA &dataset, const TimeSeries &query, size_t k, const SearchOptions &options)
+{
+    return topKOuter(dataset, query, k, options);
+}
+
+std::vector<Match> SearchEngine::searchTopKAoS(const TimeSeriesAoS &dataset, const TimeSeries &query, size_t k, const SearchOptions &options)
+{
+    return topKOuter(dataset, query, k, options);
+}
+
+std::vector<std::vector<Match>> SearchEngine::searchTopKPerSeriesSoA(const TimeSeriesSoA &dataset, const TimeSeries &query, size_t k, const SearchOptions &options)
+{
+    return topKPerSeries(dataset, query, k, options);
+}
+
+std::vector<std::vector<Match>> SearchEngine::searchTopKPerSeriesAoS(const TimeSeriesAoS &dataset, const TimeSeries &query, size_t k, const SearchOptions &options)
+{
+    return topKPerSeries(dataset, query, k, options);
+}
+
+std::pair<std::vector<double>, size_t> SearchEngine::searchApproximateSoA(const TimeSeriesSoA &dataset, const TimeSeries &query, const ApproximateOptions &approximate, const SearchOptions &options)
+{
+    return approximateSearch(dataset, query, approximate, options);
+}
+
+std::pair<std::vector<double>, size_t> SearchEngine::searchApproximateAoS(const TimeSeriesAoS &dataset, const TimeSeries &query, const ApproximateOptions &approximate, const SearchOptions &options)
+{
+    return approximateSearch(dataset, query, approximate, options);
+}
+
+double SearchEngine::recallAtK(const std::vector<double> &reference, const std::vector<double> &candidate, size_t k)
+{
+    size_t numSeries = std::min(reference.size(), candidate.size());
+    k = std::min(k, numSeries);
+    if (k == 0)
+        return 1.0;
+
+    auto topK = [&](const std::vector<double> &values)
+    {
+        std::vector<size_t> order(numSeries);
+        std::iota(order.begin(), order.end(), 0);
+        std::partial_sort(order.begin(), order.begin() + k, order.end(), [&](size_t a, size_t b)
+                          { return values[a] < values[b] || (values[a] == values[b] && a < b); });
+        order.resize(k);
+        std::sort(order.begin(), order.end());
+        return order;
+    };
+
+    std::vector<size_t> expected = topK(reference);
+    std::vector<size_t> found = topK(candidate);
+    std::vector<size_t> common;
+    std::set_intersection(expected.begin(), expected.end(), found.begin(), found.end(), std::back_inserter(common));
+    return static_cast<double>(common.size()) / k;
+}
+
+ApproximateOptions SearchEngine::calibrateApproximateSoA(const TimeSeriesSoA &dataset, const std::vector<TimeSeries> &queries, double recallTarget, size_t k, const SearchOptions &options)
+{
+    ApproximateOptions exact;
+    exact.stride = 1;
+    exact.refineFraction = 1.0;
+    if (queries.empty())
+        return exact;
+
+    std::vector<std::vector<double>> references;
+    for (const TimeSeries &query : queries)
+    {
+        references.push_back(searchSequentialSoA(dataset, query, options).first);
+    }
+
+    ApproximateOptions chosen = exact;
+    double chosenMs = std::numeric_limits<double>::max();
+
+    for (size_t stride : {2, 4, 8, 16, 32})
+    {
+        if (stride > queries[0].getSize())
+            break;
+
+        for (double fraction : {0.01, 0.05, 0.1, 0.25, 0.5, 1.0})
+        {
+            ApproximateOptions candidate;
+            candidate.stride = stride;
+            candidate.refineFraction = fraction;
+
+            double recall = 0.0;
+            double start = omp_get_wtime();
+            for (size_t q = 0; q < queries.size(); ++q)
+            {
+                recall += recallAtK(references[q], searchApproximateSoA(dataset, queries[q], candidate, options).first, k);
+            }
+            double elapsedMs = (omp_get_wtime() - start) * 1000.0;
+
+            if (recall / queries.size() >= recallTarget && elapsedMs < chosenMs)
+            {
+                chosen = candidate;
+                chosenMs = elapsedMs;
+            }
         }
     }
 
-    return {sadValues, bestIndex};
+    return chosen;
 }
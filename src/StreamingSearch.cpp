@@ -0,0 +1,158 @@
+#include "../include/StreamingSearch.h"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+    // Offset valutati per chiamata al kernel (buffer in stack)
+    constexpr size_t STREAM_CHUNK = 256;
+
+    // La storia viene compattata (tenendo gli ultimi queryLength - 1 campioni)
+    // quando i campioni scartabili sono almeno max(queryLength, questa soglia):
+    // la copia costa quindi O(1) ammortizzato per campione
+    constexpr size_t HISTORY_COMPACT_MIN = 4096;
+}
+
+StreamingSearch::StreamingSearch(const TimeSeries &query, size_t numSeries, const SearchOptions &options)
+    : kernel(SadKernels::active(options.metric)), query(query.getData()), queryLength(query.getSize()),
+      options(options), series(numSeries), globalBestSad(std::numeric_limits<double>::max()),
+      globalBest{0, 0, std::numeric_limits<double>::max()}
+{
+    if (options.metric == DistanceMetric::ZNormEuclidean)
+    {
+        zNormalize(query.getData().data(), queryLength, this->query.data());
+    }
+}
+
+size_t StreamingSearch::addSeries()
+{
+    series.emplace_back();
+    return series.size() - 1;
+}
+
+void StreamingSearch::append(size_t seriesIndex, const double *values, size_t count)
+{
+    SeriesState &state = series[seriesIndex];
+    state.samplesSeen += count;
+    if (queryLength == 0 || count == 0)
+        return;
+
+    AlignedVector<double> &history = state.history;
+    size_t keep = queryLength - 1;
+    size_t drop = history.size() > keep ? history.size() - keep : 0;
+    if (drop >= std::max(queryLength, HISTORY_COMPACT_MIN))
+    {
+        std::copy(history.end() - keep, history.end(), history.begin());
+        history.resize(keep);
+        state.historyStart += drop;
+    }
+
+    size_t oldSize = history.size();
+    history.insert(history.end(), values, values + count);
+    if (history.size() < queryLength)
+        return;
+
+    // Solo le finestre che terminano in uno dei nuovi campioni
+    size_t first = oldSize > keep ? oldSize - keep : 0;
+    size_t newOffsets = history.size() - queryLength + 1 - first;
+    state.stats.totalTerms += newOffsets * queryLength;
+
+    double previousBest = state.bestSad;
+    double buffer[STREAM_CHUNK];
+
+    for (size_t j = first; j < first + newOffsets; j += STREAM_CHUNK)
+    {
+        size_t chunk = std::min(STREAM_CHUNK, first + newOffsets - j);
+        double threshold = options.earlyAbandon ? state.bestSad : std::numeric_limits<double>::max();
+
+        kernel.slidingSadEarlyAbandon(history.data() + j, query.data(), queryLength, chunk,
+                                      threshold, buffer, &state.stats.evaluatedTerms);
+
+        for (size_t o = 0; o < chunk; ++o)
+        {
+            if (buffer[o] < state.bestSad)
+            {
+                state.bestSad = buffer[o];
+                state.bestOffset = state.historyStart + j + o;
+            }
+        }
+    }
+
+    if (state.bestSad < previousBest)
+    {
+        publishBest(seriesIndex, state);
+    }
+}
+
+void StreamingSearch::append(size_t seriesIndex, const std::vector<double> &values)
+{
+    append(seriesIndex, values.data(), values.size());
+}
+
+void StreamingSearch::appendAll(const std::vector<std::vector<double>> &values)
+{
+    size_t count = std::min(values.size(), series.size());
+
+#pragma omp parallel for schedule(dynamic)
+    for (size_t i = 0; i < count; ++i)
+    {
+        append(i, values[i]);
+    }
+}
+
+void StreamingSearch::publishBest(size_t seriesIndex, const SeriesState &state)
+{
+    // I best delle serie possono solo diminuire, quindi anche quello globale:
+    // la sezione critica serve solo quando la serie può superarlo
+    if (state.bestSad > globalBestSad.load(std::memory_order_relaxed))
+        return;
+
+#pragma omp critical(streaming_global_best)
+    {
+        if (state.bestSad < globalBest.sad ||
+            (state.bestSad == globalBest.sad && seriesIndex < globalBest.seriesIndex))
+        {
+            globalBest = {seriesIndex, state.bestOffset, state.bestSad};
+            globalBestSad.store(state.bestSad, std::memory_order_relaxed);
+        }
+    }
+}
+
+Match StreamingSearch::getBestMatch(size_t seriesIndex) const
+{
+    const SeriesState &state = series[seriesIndex];
+    return {seriesIndex, state.bestOffset, state.bestSad};
+}
+
+Match StreamingSearch::getBestMatch() const
+{
+    Match best;
+#pragma omp critical(streaming_global_best)
+    best = globalBest;
+    return best;
+}
+
+size_t StreamingSearch::getSamplesSeen(size_t seriesIndex) const
+{
+    return series[seriesIndex].samplesSeen;
+}
+
+std::pair<std::vector<double>, size_t> StreamingSearch::getResults() const
+{
+    std::vector<double> sadValues(series.size());
+    for (size_t i = 0; i < series.size(); ++i)
+    {
+        sadValues[i] = series[i].bestSad;
+    }
+    return {std::move(sadValues), getBestMatch().seriesIndex};
+}
+
+SearchStats StreamingSearch::getStats() const
+{
+    SearchStats stats;
+    for (const SeriesState &state : series)
+    {
+        stats += state.stats;
+    }
+    return stats;
+}
@@ -0,0 +1,93 @@
+#include "../include/SyntheticGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+
+namespace
+{
+    constexpr double PI = 3.14159265358979323846;
+
+    // Flussi separati per le serie (0 .. numSeries-1), la query e le posizioni
+    // delle occorrenze piantate
+    constexpr uint64_t QUERY_STREAM = ~uint64_t(0);
+    constexpr uint64_t PLANT_STREAM = ~uint64_t(0) - 1;
+
+    // splitmix64: semi ben distribuiti anche per indici consecutivi
+    uint64_t streamSeed(uint64_t seed, uint64_t stream)
+    {
+        uint64_t z = seed + 0x9E3779B97F4A7C15ULL * (stream + 1);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Scrive length campioni a distanza stride
+    void generateSeries(const SyntheticSpec &spec, uint64_t stream, double *dst, size_t length, size_t stride)
+    {
+        std::mt19937_64 rng(streamSeed(spec.seed, stream));
+        std::normal_distribution<double> noise(0.0, spec.noiseStd);
+        double omega = 2.0 * PI / spec.period;
+
+        for (size_t t = 0; t < length; ++t)
+        {
+            double time = static_cast<double>(t);
+            dst[t * stride] = spec.base + spec.trendPerPoint * time + spec.amplitude * std::sin(omega * time) + noise(rng);
+        }
+    }
+}
+
+TimeSeries SyntheticGenerator::generateQuery(const SyntheticSpec &spec)
+{
+    std::vector<double> values(spec.queryLength);
+    generateSeries(spec, QUERY_STREAM, values.data(), values.size(), 1);
+    return TimeSeries(values);
+}
+
+TimeSeriesSoA SyntheticGenerator::generate(const SyntheticSpec &spec,
+                                           StorageLayout layout,
+                                           const TimeSeries &query,
+                                           std::vector<PlantedOccurrence> *planted)
+{
+    FlatStorage<double> storage(layout);
+    storage.allocate(std::vector<size_t>(spec.numSeries, spec.seriesLength));
+    size_t stride = storage.getStride();
+
+    // Ogni serie scritta dal thread che la genera (first touch)
+#pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < spec.numSeries; ++i)
+    {
+        generateSeries(spec, i, storage.getMutableSeriesData(i), spec.seriesLength, stride);
+    }
+
+    if (planted != nullptr)
+        planted->clear();
+
+    size_t queryLength = query.getSize();
+    if (spec.plantedQueries > 0 && queryLength > 0 && queryLength <= spec.seriesLength)
+    {
+        std::mt19937_64 rng(streamSeed(spec.seed, PLANT_STREAM));
+
+        // Serie distinte, al più una occorrenza per serie
+        std::vector<size_t> series(spec.numSeries);
+        std::iota(series.begin(), series.end(), 0);
+        std::vector<size_t> chosen;
+        std::sample(series.begin(), series.end(), std::back_inserter(chosen),
+                    std::min(spec.plantedQueries, spec.numSeries), rng);
+
+        std::uniform_int_distribution<size_t> position(0, spec.seriesLength - queryLength);
+        for (size_t s : chosen)
+        {
+            size_t p = position(rng);
+            double *dst = storage.getMutableSeriesData(s) + p * stride;
+            for (size_t j = 0; j < queryLength; ++j)
+            {
+                dst[j * stride] = query.getValue(j);
+            }
+            if (planted != nullptr)
+                planted->push_back({s, p});
+        }
+    }
+
+    return TimeSeriesSoA(std::move(storage));
+}
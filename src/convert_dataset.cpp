@@ -0,0 +1,116 @@
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "../include/BinaryDataset.h"
+#include "../include/DataLoading.h"
+#include "../include/SyntheticGenerator.h"
+
+namespace
+{
+    // "synthetic:NxLxQ[:seed]" -> spec del generatore nativo
+    bool parseSynthetic(const std::string &input, SyntheticSpec &spec)
+    {
+        const std::string prefix = "synthetic:";
+        if (input.compare(0, prefix.size(), prefix) != 0)
+            return false;
+
+        unsigned long long seed = spec.seed;
+        char x1 = 0, x2 = 0;
+        std::istringstream stream(input.substr(prefix.size()));
+        stream >> spec.numSeries >> x1 >> spec.seriesLength >> x2 >> spec.queryLength;
+        if (!stream || x1 != 'x' || x2 != 'x')
+            return false;
+        if (stream.peek() == ':')
+        {
+            stream.get();
+            stream >> seed;
+        }
+        spec.seed = seed;
+        return static_cast<bool>(stream) && spec.numSeries > 0 && spec.seriesLength > 0;
+    }
+
+    // Query su una riga, come i CSV di generate_timeseries.py
+    bool writeQueryCsv(const std::string &filename, const TimeSeries &query)
+    {
+        std::ofstream file(filename);
+        if (!file.is_open())
+        {
+            std::cerr << "Errore: impossibile scrivere il file " << filename << std::endl;
+            return false;
+        }
+        file << std::setprecision(17);
+        for (size_t i = 0; i < query.getSize(); ++i)
+        {
+            file << (i > 0 ? "," : "") << query.getValue(i);
+        }
+        file << "\n";
+        return static_cast<bool>(file);
+    }
+}
+
+// Converte un dataset CSV nel formato binario mappabile (BinaryDataset.h),
+// oppure genera direttamente in quel formato un dataset sintetico
+int main(int argc, char **argv)
+{
+    if (argc < 3 || argc > 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " <input.csv | synthetic:NxLxQ[:seed]> <output.bin> [row_major|column_major|tiled]" << std::endl;
+        return 1;
+    }
+
+    std::string input = argv[1];
+    std::string output = argv[2];
+    StorageLayout layout = StorageLayout::RowMajor;
+    if (argc == 4 && !parseStorageLayout(argv[3], layout))
+    {
+        std::cerr << "Unknown layout: " << argv[3] << std::endl;
+        return 1;
+    }
+
+    SyntheticSpec spec;
+    bool synthetic = input.compare(0, 10, "synthetic:") == 0;
+    if (synthetic && !parseSynthetic(input, spec))
+    {
+        std::cerr << "Invalid synthetic dataset: " << input << " (expected synthetic:NxLxQ[:seed])" << std::endl;
+        return 1;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    TimeSeriesSoA dataset(layout);
+    if (synthetic)
+    {
+        // La query accanto al file binario, per poterla cercare nel dataset
+        TimeSeries query = SyntheticGenerator::generateQuery(spec);
+        dataset = SyntheticGenerator::generate(spec, layout, query);
+        if (query.getSize() > 0 && !writeQueryCsv(output + ".query.csv", query))
+            return 1;
+    }
+    else
+    {
+        dataset = loadTimeSeriesSoA(input, layout);
+    }
+    auto parsed = std::chrono::high_resolution_clock::now();
+
+    if (dataset.getNumSeries() == 0)
+    {
+        std::cerr << "No series loaded from " << input << std::endl;
+        return 1;
+    }
+
+    if (!writeBinaryDataset(output, dataset))
+        return 1;
+    auto written = std::chrono::high_resolution_clock::now();
+
+    auto ms = [](auto from, auto to)
+    {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+
+    std::cout << (synthetic ? "Generated " : "Converted ") << dataset.getNumSeries() << " series (" << storageLayoutName(layout) << ", "
+              << dataset.sizeInBytes() << " bytes) in " << ms(start, written) << " ms"
+              << " (" << (synthetic ? "generate " : "parse ") << ms(start, parsed) << " ms, write " << ms(parsed, written) << " ms)" << std::endl;
+    return 0;
+}
@@ -2,46 +2,61 @@
 #include <vector>
 #include <string>
 #include "../include/Benchmark.h"
+#include "../include/BenchmarkConfig.h"
 #include <fstream>
 #include <filesystem>
 #include <iomanip>
 
-int main()
+int main(int argc, char **argv)
 {
-    const int NUM_RUNS = 10;
-
-    std::vector<int> thread_counts = {2, 4, 8, 16, 24, 32, 48, 64};
-
-    std::vector<TestConfiguration> configurations;
+    BenchmarkPlan plan;
+    std::string error;
+    if (!BenchmarkConfig::parseArguments(argc, argv, plan, error))
+    {
+        std::cerr << "Error: " << error << "\n\n"
+                  << BenchmarkConfig::usage(argv[0]);
+        return 1;
+    }
 
-    // configurazione dei test: num_series, series_length, query_length
-    std::vector<std::tuple<int, int, int>> test_cases = {
-        {1000, 100, 50},
-        {5000, 100, 50},
+    if (plan.help)
+    {
+        std::cout << BenchmarkConfig::usage(argv[0]);
+        return 0;
+    }
 
-        {10, 5000, 50},
-        {5, 10000, 50},
-    };
+    if (plan.list_benchmarks)
+    {
+        for (const BenchmarkStrategy &strategy : BenchmarkRegistry::all())
+        {
+            std::cout << std::left << std::setw(24) << strategy.id() << strategy.label
+                      << (strategy.parallel ? "" : " (baseline)") << std::endl;
+        }
+        return 0;
+    }
 
-    for (const auto &[num_series, series_length, query_length] : test_cases)
+    for (const TestConfiguration &config : plan.tests)
     {
-        TestConfiguration config;
-        config.num_series = num_series;
-        config.series_length = series_length;
-        config.query_length = query_length;
-        config.num_runs = NUM_RUNS;
-        config.thread_counts = thread_counts;
-        configurations.push_back(config);
+        if (BenchmarkRegistry::select(config.benchmarks).empty())
+        {
+            std::cerr << "No benchmark matches " << config.benchmarks << " (see --list-benchmarks)" << std::endl;
+            return 1;
+        }
     }
 
-    auto results = Benchmark::run_multiple_tests(configurations);
+    auto results = Benchmark::run_multiple_tests(plan.tests);
 
-    std::filesystem::create_directories("output/benchmark_results");
-    std::string output_filename = "output/benchmark_results/parallelization_analysis.json";
-    std::ofstream output_file(output_filename);
+    std::filesystem::path output_path(plan.output_path);
+    if (output_path.has_parent_path())
+        std::filesystem::create_directories(output_path.parent_path());
+    std::ofstream output_file(output_path);
+    if (!output_file)
+    {
+        std::cerr << "Cannot write results to " << plan.output_path << std::endl;
+        return 1;
+    }
     output_file << results.dump(2);
     output_file.close();
 
-    std::cout << "\nResults saved to: " << output_filename << std::endl;
+    std::cout << "\nResults saved to: " << plan.output_path << std::endl;
     return 0;
-}
\ No newline at end of file
+}